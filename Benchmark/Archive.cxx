@@ -0,0 +1,209 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Archive.h"
+#include "Stream.h"
+#include "Harness.h"
+
+
+namespace {
+
+template<class T>
+void RunScalar(const char *, T, Gink::IntegerEncoding);
+
+template<class T>
+void RunVector(const char *, std::size_t, Gink::IntegerEncoding);
+
+void RunString(const char *, std::size_t);
+
+} // namespace
+
+
+int
+main(int argc, char **argv)
+{
+    Gink::InitializeBenchmarks(argc, argv);
+    const Gink::IntegerEncoding fixed = Gink::IntegerEncoding::Fixed;
+    const Gink::IntegerEncoding compact = Gink::IntegerEncoding::Compact;
+    RunScalar<std::uint32_t>("Archive/uint32", 0x12345678, fixed);
+    RunScalar<std::uint64_t>("Archive/uint64", 0x123456789ABCDEF0, fixed);
+    RunScalar<std::uint64_t>("Archive/uint64-compact-small", 100, compact);
+    RunScalar<std::uint64_t>("Archive/uint64-compact-large", 0x123456789ABCDEF0, compact);
+    RunScalar<std::int32_t>("Archive/int32-compact-negative", -1000, compact);
+    RunScalar<double>("Archive/double", 3.25, fixed);
+    RunString("Archive/string-16", 16);
+    RunString("Archive/string-4k", 4096);
+    RunVector<std::uint32_t>("Archive/vector-uint32-100k", 100000, fixed);
+    RunVector<std::uint64_t>("Archive/vector-uint64-100k", 100000, fixed);
+    RunVector<std::uint32_t>("Archive/vector-uint32-100k-compact", 100000, compact);
+    RunVector<float>("Archive/vector-float-100k", 100000, fixed);
+    return 0;
+}
+
+
+namespace {
+
+template<class T>
+void
+RunScalar(const char *name, T value, Gink::IntegerEncoding integerEncoding)
+{
+    const int batchSize = 1000;
+    Gink::Stream stream;
+    std::size_t size = Gink::SizeArchive::Measure(value, integerEncoding);
+
+    Gink::RunBenchmark((std::string(name) + "/encode").c_str(), size, [&] (int n) {
+        Gink::Archive archive(&stream, integerEncoding);
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            archive << value;
+
+            if (i % batchSize == batchSize - 1) {
+                archive.flush();
+                stream.read(nullptr, stream.getDataSize());
+            }
+        }
+
+        archive.flush();
+        stream.read(nullptr, stream.getDataSize());
+    });
+
+    {
+        Gink::Archive archive(&stream, integerEncoding);
+        int i;
+
+        for (i = 0; i < batchSize; ++i) {
+            archive << value;
+        }
+
+        archive.flush();
+    }
+
+    Gink::Stream input;
+
+    Gink::RunBenchmark((std::string(name) + "/decode").c_str(), size, [&] (int n) {
+        Gink::Archive archive(&input, integerEncoding);
+        T result;
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            if (i % batchSize == 0) {
+                archive.flush();
+                input.write(stream.getData(), stream.getDataSize());
+            }
+
+            archive >> result;
+            Gink::KeepValue(result);
+        }
+
+        archive.flush();
+        input.read(nullptr, input.getDataSize());
+    });
+}
+
+
+template<class T>
+void
+RunVector(const char *name, std::size_t length, Gink::IntegerEncoding integerEncoding)
+{
+    std::vector<T> vector(length);
+    std::size_t i;
+
+    for (i = 0; i < length; ++i) {
+        vector[i] = static_cast<T>(i * 7);
+    }
+
+    std::size_t size = Gink::SizeArchive::Measure(vector, integerEncoding);
+    Gink::Stream stream;
+
+    Gink::RunBenchmark((std::string(name) + "/encode").c_str(), size, [&] (int n) {
+        Gink::Archive archive(&stream, integerEncoding);
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            archive << vector;
+            archive.flush();
+            stream.read(nullptr, stream.getDataSize());
+        }
+    });
+
+    {
+        Gink::Archive archive(&stream, integerEncoding);
+        archive << vector;
+        archive.flush();
+    }
+
+    Gink::Stream input;
+
+    Gink::RunBenchmark((std::string(name) + "/decode").c_str(), size, [&] (int n) {
+        Gink::Archive archive(&input, integerEncoding);
+        std::vector<T> result;
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            input.write(stream.getData(), stream.getDataSize());
+            result.clear();
+            archive >> result;
+            archive.flush();
+            Gink::KeepValue(result);
+        }
+    });
+}
+
+
+void
+RunString(const char *name, std::size_t length)
+{
+    std::string string(length, 'x');
+    std::size_t size = Gink::SizeArchive::Measure(string);
+    Gink::Stream stream;
+
+    Gink::RunBenchmark((std::string(name) + "/encode").c_str(), size, [&] (int n) {
+        Gink::Archive archive(&stream);
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            archive << string;
+            archive.flush();
+            stream.read(nullptr, stream.getDataSize());
+        }
+    });
+
+    {
+        Gink::Archive archive(&stream);
+        archive << string;
+        archive.flush();
+    }
+
+    Gink::Stream input;
+
+    Gink::RunBenchmark((std::string(name) + "/decode").c_str(), size, [&] (int n) {
+        Gink::Archive archive(&input);
+        std::string result;
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            input.write(stream.getData(), stream.getDataSize());
+            result.clear();
+            archive >> result;
+            archive.flush();
+            Gink::KeepValue(result);
+        }
+    });
+
+    Gink::RunBenchmark((std::string(name) + "/decode-view").c_str(), size, [&] (int n) {
+        Gink::Archive archive(&input);
+        Gink::BytesView result;
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            input.write(stream.getData(), stream.getDataSize());
+            archive >> result;
+            Gink::KeepValue(result);
+            archive.flush();
+        }
+    });
+}
+
+} // namespace
@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Archive.h"
+#include "Stream.h"
+#include "Harness.h"
+
+
+namespace {
+
+struct Node
+{
+    std::uint32_t id;
+    std::string name;
+    std::vector<std::uint64_t> values;
+    std::vector<Node> children;
+
+    template<class T>
+    void store(T *archive) const
+    {
+        *archive << id << name << values << children;
+    }
+
+    void load(Gink::Archive *archive)
+    {
+        *archive >> id >> name >> values >> children;
+    }
+};
+
+
+Node MakeTree(int, int, std::uint32_t *);
+void Run(const std::string &, const Node &, bool);
+
+} // namespace
+
+
+int
+main(int argc, char **argv)
+{
+    Gink::InitializeBenchmarks(argc, argv);
+
+    static const struct {
+        const char *name;
+        int depth;
+        int fanout;
+    } shapes[] = {
+        {"depth4-fanout4", 4, 4},
+        {"depth8-fanout2", 8, 2},
+        {"depth16-fanout1", 16, 1},
+    };
+
+    for (const auto &shape: shapes) {
+        std::uint32_t id = 0;
+        Node tree = MakeTree(shape.depth, shape.fanout, &id);
+        Run(shape.name, tree, false);
+        Run(shape.name, tree, true);
+    }
+
+    return 0;
+}
+
+
+namespace {
+
+Node
+MakeTree(int depth, int fanout, std::uint32_t *id)
+{
+    Node node;
+    node.id = (*id)++;
+    node.name = "node-" + std::to_string(node.id);
+    node.values.assign(node.id % 16 + 1, node.id);
+
+    if (depth >= 2) {
+        int i;
+
+        for (i = 0; i < fanout; ++i) {
+            node.children.push_back(MakeTree(depth - 1, fanout, id));
+        }
+    }
+
+    return node;
+}
+
+
+void
+Run(const std::string &name, const Node &tree, bool reserves)
+{
+    std::string fullName = "ArchiveReserve/" + name + (reserves ? "/reserve" : "/grow");
+
+    Gink::RunBenchmark(fullName.c_str(), Gink::SizeArchive::Measure(tree), [&] (int n) {
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            Gink::Stream stream;
+            Gink::Archive archive(&stream);
+
+            if (reserves) {
+                archive.reserve(Gink::SizeArchive::Measure(tree));
+            }
+
+            archive << tree;
+            archive.flush();
+            Gink::KeepValue(stream);
+        }
+    });
+}
+
+} // namespace
@@ -0,0 +1,76 @@
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BufferPool.h"
+#include "Stream.h"
+#include "Harness.h"
+
+
+namespace {
+
+void Run(const char *, Gink::Allocator *);
+
+} // namespace
+
+
+int
+main(int argc, char **argv)
+{
+    Gink::InitializeBenchmarks(argc, argv);
+    Run("BufferPool/connections-10k-burst-64k/unpooled", nullptr);
+    Run("BufferPool/connections-10k-burst-64k/pooled", Gink::BufferPool::GetInstance());
+    Gink::BufferPool::Statistics statistics = Gink::BufferPool::GetInstance()->getStatistics();
+    Gink::ReportMetric("BufferPool/hit-rate", "ratio", statistics.hitRate);
+    Gink::ReportMetric("BufferPool/resident", "bytes", statistics.residentByteCount);
+    return 0;
+}
+
+
+namespace {
+
+void
+Run(const char *name, Gink::Allocator *allocator)
+{
+    const std::size_t numberOfStreams = 10000;
+    const std::size_t burstSize = 65536;
+    const std::size_t chunkSize = 4096;
+    std::vector<std::unique_ptr<Gink::Stream>> streams;
+    std::size_t i;
+
+    for (i = 0; i < numberOfStreams; ++i) {
+        streams.emplace_back(new Gink::Stream(allocator));
+    }
+
+    std::string chunk(chunkSize, 'x');
+    std::size_t k = 0;
+
+    Gink::RunBenchmark(name, burstSize, [&] (int n) {
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            Gink::Stream *stream = streams[k].get();
+            k = (k + 7919) % numberOfStreams;
+            std::size_t j;
+
+            for (j = 0; j < burstSize; j += chunkSize) {
+                stream->write(chunk.data(), chunkSize);
+            }
+
+            while (stream->getDataSize() >= 1) {
+                stream->read(nullptr, chunkSize);
+            }
+        }
+    });
+
+    std::size_t pinnedByteCount = 0;
+
+    for (const auto &stream: streams) {
+        pinnedByteCount += stream->getBufferSize();
+    }
+
+    Gink::ReportMetric((std::string(name) + "/pinned").c_str(), "bytes", pinnedByteCount);
+}
+
+} // namespace
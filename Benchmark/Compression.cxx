@@ -0,0 +1,118 @@
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Archive.h"
+#include "Compression.h"
+#include "Stream.h"
+#include "Harness.h"
+
+
+namespace {
+
+struct Record
+{
+    std::string key;
+    std::uint64_t version;
+    std::vector<std::uint32_t> ids;
+
+    GINK_SERIALIZABLE(Record, key, version, ids)
+};
+
+
+void MakePayload(Gink::Stream *, int, Gink::IntegerEncoding);
+void Run(const std::string &, Gink::Stream *);
+
+} // namespace
+
+
+int
+main(int argc, char **argv)
+{
+    Gink::InitializeBenchmarks(argc, argv);
+
+    static const struct {
+        const char *name;
+        int numberOfRecords;
+        Gink::IntegerEncoding integerEncoding;
+    } payloads[] = {
+        {"records-1k", 1000, Gink::IntegerEncoding::Fixed},
+        {"records-1k-compact", 1000, Gink::IntegerEncoding::Compact},
+        {"records-10k", 10000, Gink::IntegerEncoding::Fixed},
+    };
+
+    for (const auto &payload: payloads) {
+        Gink::Stream stream;
+        MakePayload(&stream, payload.numberOfRecords, payload.integerEncoding);
+        Run(payload.name, &stream);
+    }
+
+    return 0;
+}
+
+
+namespace {
+
+void
+MakePayload(Gink::Stream *stream, int numberOfRecords, Gink::IntegerEncoding integerEncoding)
+{
+    std::mt19937 randomEngine(numberOfRecords);
+    std::vector<Record> records(numberOfRecords);
+
+    for (Record &record: records) {
+        record.key = "user:" + std::to_string(randomEngine() % 500) + ":session:"
+                     + std::to_string(randomEngine() % 20);
+        record.version = randomEngine() % 1000;
+        std::uint32_t id = randomEngine() % 100000;
+
+        for (int i = randomEngine() % 32; i >= 0; --i) {
+            record.ids.push_back(id);
+            id += randomEngine() % 8;
+        }
+    }
+
+    Gink::Archive archive(stream, integerEncoding);
+    archive << records;
+    archive.flush();
+}
+
+
+void
+Run(const std::string &name, Gink::Stream *payload)
+{
+    std::size_t payloadSize = payload->getDataSize();
+    Gink::Compressor compressor;
+    Gink::Decompressor decompressor;
+    Gink::Stream input;
+    Gink::Stream frame;
+    Gink::Stream output;
+
+    Gink::RunBenchmark(("Compression/" + name + "/compress").c_str(), payloadSize, [&] (int n) {
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            input.write(payload->getData(), payloadSize);
+            frame.read(nullptr, frame.getDataSize());
+            compressor.compress(&input, &frame);
+        }
+    });
+
+    std::size_t frameSize = frame.getDataSize();
+    Gink::ReportMetric(("Compression/" + name + "/ratio").c_str(), "ratio"
+                       , static_cast<double>(payloadSize) / frameSize);
+    Gink::Stream frameCopy;
+    frameCopy.write(frame.getData(), frameSize);
+
+    Gink::RunBenchmark(("Compression/" + name + "/decompress").c_str(), payloadSize, [&] (int n) {
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            frame.write(frameCopy.getData(), frameSize);
+            output.read(nullptr, output.getDataSize());
+            decompressor.decompress(&frame, &output);
+        }
+    });
+}
+
+} // namespace
@@ -0,0 +1,72 @@
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SegmentedStream.h"
+#include "SharedBuffer.h"
+#include "Harness.h"
+
+
+namespace {
+
+void Run(const char *, std::size_t, std::size_t, bool);
+
+} // namespace
+
+
+int
+main(int argc, char **argv)
+{
+    Gink::InitializeBenchmarks(argc, argv);
+    Run("FanOut/message-1k-subscribers-1k/copy", 1024, 1000, false);
+    Run("FanOut/message-1k-subscribers-1k/shared", 1024, 1000, true);
+    Run("FanOut/message-64k-subscribers-1k/copy", 65536, 1000, false);
+    Run("FanOut/message-64k-subscribers-1k/shared", 65536, 1000, true);
+    return 0;
+}
+
+
+namespace {
+
+void
+Run(const char *name, std::size_t messageSize, std::size_t numberOfSubscribers, bool isShared)
+{
+    std::vector<std::unique_ptr<Gink::SegmentedStream>> streams;
+    std::size_t i;
+
+    for (i = 0; i < numberOfSubscribers; ++i) {
+        streams.emplace_back(new Gink::SegmentedStream());
+    }
+
+    std::string message(messageSize, 'x');
+
+    Gink::RunBenchmark(name, messageSize * numberOfSubscribers, [&] (int n) {
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            Gink::SharedBuffer sharedBuffer;
+
+            if (isShared) {
+                sharedBuffer = Gink::SharedBuffer(message.data(), message.size());
+            }
+
+            for (const auto &stream: streams) {
+                if (isShared) {
+                    stream->write(sharedBuffer);
+                } else {
+                    stream->write(message.data(), message.size());
+                }
+
+                ::iovec vector[16];
+                int vectorLength = stream->getData(vector, 16);
+                Gink::KeepValue(vector[vectorLength - 1]);
+                stream->read(nullptr, stream->getDataSize());
+            }
+        }
+    });
+}
+
+} // namespace
@@ -0,0 +1,123 @@
+#include "Harness.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <new>
+
+
+namespace Gink {
+
+namespace {
+
+std::size_t NumberOfAllocations;
+bool OutputsJSON;
+double MinTime = 0.2;
+
+} // namespace
+
+
+void
+InitializeBenchmarks(int argc, char **argv)
+{
+    int i;
+
+    for (i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            OutputsJSON = true;
+        } else if (std::strncmp(argv[i], "--min-time=", 11) == 0) {
+            MinTime = std::atof(argv[i] + 11);
+        } else {
+            std::fprintf(stderr, "usage: %s [--json] [--min-time=SECONDS]\n", argv[0]);
+            std::exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+void
+RunBenchmark(const char *name, std::size_t numberOfBytesPerOperation
+             , const std::function<void (int)> &operation)
+{
+    int numberOfIterations = 1;
+    double time;
+    std::size_t numberOfAllocations;
+
+    for (;;) {
+        numberOfAllocations = NumberOfAllocations;
+        auto t0 = std::chrono::steady_clock::now();
+        operation(numberOfIterations);
+        auto t1 = std::chrono::steady_clock::now();
+        numberOfAllocations = NumberOfAllocations - numberOfAllocations;
+        time = std::chrono::duration<double>(t1 - t0).count();
+
+        if (time >= MinTime || numberOfIterations >= 1 << 30) {
+            break;
+        }
+
+        numberOfIterations *= time * 10 < MinTime ? 10 : 2;
+    }
+
+    double nsPerOperation = time * 1e9 / numberOfIterations;
+    double bytesPerSecond = static_cast<double>(numberOfBytesPerOperation) * numberOfIterations
+                            / time;
+    double allocationsPerOperation = static_cast<double>(numberOfAllocations)
+                                     / numberOfIterations;
+
+    if (OutputsJSON) {
+        std::printf("{\"name\": \"%s\", \"iterations\": %d, \"ns_per_op\": %.3f"
+                    ", \"bytes_per_second\": %.0f, \"allocs_per_op\": %.3f}\n", name
+                    , numberOfIterations, nsPerOperation, bytesPerSecond
+                    , allocationsPerOperation);
+    } else {
+        std::printf("%-40s %12d %12.1f ns/op %10.1f MB/s %8.2f allocs/op\n", name
+                    , numberOfIterations, nsPerOperation, bytesPerSecond / 1e6
+                    , allocationsPerOperation);
+    }
+
+    std::fflush(stdout);
+}
+
+
+void
+ReportMetric(const char *name, const char *unit, double value)
+{
+    if (OutputsJSON) {
+        std::printf("{\"name\": \"%s\", \"%s\": %.3f}\n", name, unit, value);
+    } else {
+        std::printf("%-40s %12.3f %s\n", name, value, unit);
+    }
+
+    std::fflush(stdout);
+}
+
+
+std::size_t
+GetNumberOfAllocations()
+{
+    return NumberOfAllocations;
+}
+
+} // namespace Gink
+
+
+void *
+operator new(std::size_t size)
+{
+    ++Gink::NumberOfAllocations;
+    void *memory = std::malloc(size == 0 ? 1 : size);
+
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+
+void
+operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+
+#include <cstddef>
+#include <functional>
+
+
+namespace Gink {
+
+void InitializeBenchmarks(int, char **);
+void RunBenchmark(const char *, std::size_t, const std::function<void (int)> &);
+void ReportMetric(const char *, const char *, double);
+std::size_t GetNumberOfAllocations();
+
+
+template<class T>
+inline void
+KeepValue(const T &value)
+{
+    __asm__ __volatile__ ("" : : "g"(&value) : "memory");
+}
+
+} // namespace Gink
@@ -0,0 +1,120 @@
+#include <unistd.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "Coroutine.h"
+#include "Stream.h"
+#include "TCPSocket.h"
+#include "UnixSocket.h"
+#include "Harness.h"
+
+
+namespace {
+
+template<class T>
+void Run(const char *, std::size_t, T, const std::function<T (const T &)> &);
+
+template<class T>
+void Echo(const T &, std::size_t);
+
+template<class T>
+void ReadExactly(const T &, Gink::Stream *, std::size_t);
+
+} // namespace
+
+
+int
+CoMain(int argc, char **argv)
+{
+    Gink::InitializeBenchmarks(argc, argv);
+    std::string path = "@gink-benchmark-" + std::to_string(::getpid());
+    static const std::size_t messageSizes[] = {64, 4096};
+
+    for (std::size_t messageSize: messageSizes) {
+        std::string suffix = "/message-" + std::to_string(messageSize);
+
+        Run<Gink::TCPSocket>(("SocketLatency/tcp-loopback" + suffix).c_str(), messageSize
+                             , Gink::TCPSocket::Listen("127.0.0.1", "0")
+                             , [] (const Gink::TCPSocket &listener) {
+            return Gink::TCPSocket::Connect(listener.getLocalEndpoint());
+        });
+
+        Run<Gink::UnixSocket>(("SocketLatency/unix" + suffix).c_str(), messageSize
+                              , Gink::UnixSocket::Listen(path.c_str())
+                              , [&] (const Gink::UnixSocket &) {
+            return Gink::UnixSocket::Connect(path.c_str());
+        });
+    }
+
+    return 0;
+}
+
+
+namespace {
+
+template<class T>
+void
+Run(const char *name, std::size_t messageSize, T listener
+    , const std::function<T (const T &)> &connect)
+{
+    bool isRunning = true;
+
+    Gink::CoAdd([&] {
+        T server = listener.accept();
+        Echo(server, messageSize);
+        isRunning = false;
+    });
+
+    T client = connect(listener);
+    std::string message(messageSize, 'x');
+    Gink::Stream output;
+    Gink::Stream input;
+
+    Gink::RunBenchmark(name, messageSize * 2, [&] (int n) {
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            output.write(message.data(), messageSize);
+            client.write(&output);
+            ReadExactly(client, &input, messageSize);
+            input.read(nullptr, messageSize);
+        }
+    });
+
+    client.shutdownWrite();
+
+    while (isRunning) {
+        Gink::CoYield();
+    }
+}
+
+
+template<class T>
+void
+Echo(const T &socket, std::size_t messageSize)
+{
+    Gink::Stream input;
+    Gink::Stream output;
+
+    while (socket.read(&input) >= 1) {
+        while (input.getDataSize() >= messageSize) {
+            output.write(input.getData(), messageSize);
+            input.read(nullptr, messageSize);
+            socket.write(&output);
+        }
+    }
+}
+
+
+template<class T>
+void
+ReadExactly(const T &socket, Gink::Stream *stream, std::size_t size)
+{
+    while (stream->getDataSize() < size) {
+        socket.read(stream);
+    }
+}
+
+} // namespace
@@ -0,0 +1,187 @@
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "SegmentedStream.h"
+#include "Stream.h"
+#include "Harness.h"
+
+
+namespace {
+
+class VectorStream final
+{
+public:
+    void *getBuffer();
+    void write(const void *, std::size_t);
+    void growBuffer(std::size_t);
+
+private:
+    std::vector<char> base_;
+    std::size_t wIndex_ = 0;
+};
+
+
+template<class T>
+void RunGrowth(const char *, std::size_t, std::size_t);
+
+template<class T>
+void RunGrowBuffer(const char *, std::size_t);
+
+template<class T>
+void RunPipeline(const char *, std::size_t, std::size_t);
+
+void RunShrinkToFit(const char *, std::size_t);
+
+} // namespace
+
+
+int
+main(int argc, char **argv)
+{
+    Gink::InitializeBenchmarks(argc, argv);
+    RunGrowth<VectorStream>("Stream/growth-16b-to-1m/vector", 16, 1 << 20);
+    RunGrowth<Gink::Stream>("Stream/growth-16b-to-1m", 16, 1 << 20);
+    RunGrowth<VectorStream>("Stream/growth-4k-to-16m/vector", 4096, 16 << 20);
+    RunGrowth<Gink::Stream>("Stream/growth-4k-to-16m", 4096, 16 << 20);
+    RunGrowBuffer<VectorStream>("Stream/grow-buffer-16m/vector", 16 << 20);
+    RunGrowBuffer<Gink::Stream>("Stream/grow-buffer-16m", 16 << 20);
+    RunPipeline<Gink::Stream>("Stream/pipeline-write4k-read1k", 4096, 1024);
+    RunPipeline<Gink::Stream>("Stream/pipeline-write64k-read60k", 65536, 61440);
+    RunPipeline<Gink::SegmentedStream>("SegmentedStream/pipeline-write4k-read1k", 4096, 1024);
+    RunPipeline<Gink::SegmentedStream>("SegmentedStream/pipeline-write64k-read60k", 65536
+                                       , 61440);
+    RunShrinkToFit("Stream/shrink-to-fit-1m", 1 << 20);
+    return 0;
+}
+
+
+namespace {
+
+void *
+VectorStream::getBuffer()
+{
+    return base_.data() + wIndex_;
+}
+
+
+void
+VectorStream::write(const void *data, std::size_t dataSize)
+{
+    if (base_.size() < wIndex_ + dataSize) {
+        std::size_t size = 1;
+
+        while (size < wIndex_ + dataSize) {
+            size *= 2;
+        }
+
+        base_.resize(size);
+    }
+
+    if (data != nullptr) {
+        std::memcpy(base_.data() + wIndex_, data, dataSize);
+    }
+
+    wIndex_ += dataSize;
+}
+
+
+void
+VectorStream::growBuffer(std::size_t size)
+{
+    std::size_t newSize = 1;
+
+    while (newSize < base_.size() + size) {
+        newSize *= 2;
+    }
+
+    base_.resize(newSize);
+}
+
+
+template<class T>
+void
+RunGrowth(const char *name, std::size_t chunkSize, std::size_t totalSize)
+{
+    std::string chunk(chunkSize, 'x');
+
+    Gink::RunBenchmark(name, totalSize, [&] (int n) {
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            T stream;
+            std::size_t j;
+
+            for (j = 0; j < totalSize; j += chunkSize) {
+                stream.write(chunk.data(), chunkSize);
+            }
+
+            Gink::KeepValue(stream);
+        }
+    });
+}
+
+
+template<class T>
+void
+RunGrowBuffer(const char *name, std::size_t size)
+{
+    Gink::RunBenchmark(name, size, [&] (int n) {
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            T stream;
+            stream.growBuffer(size);
+            static_cast<char *>(stream.getBuffer())[0] = 'x';
+            stream.write(nullptr, size);
+            Gink::KeepValue(stream);
+        }
+    });
+}
+
+
+template<class T>
+void
+RunPipeline(const char *name, std::size_t writeSize, std::size_t readSize)
+{
+    std::string chunk(writeSize, 'x');
+    std::string buffer(readSize, '\0');
+
+    Gink::RunBenchmark(name, writeSize, [&] (int n) {
+        T stream;
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            stream.write(chunk.data(), writeSize);
+            std::size_t j;
+
+            for (j = 0; j + readSize <= stream.getDataSize() && j < writeSize; j += readSize) {
+                stream.read(&buffer[0], readSize);
+            }
+
+            Gink::KeepValue(buffer);
+        }
+    });
+}
+
+
+void
+RunShrinkToFit(const char *name, std::size_t size)
+{
+    std::string chunk(size, 'x');
+
+    Gink::RunBenchmark(name, size, [&] (int n) {
+        int i;
+
+        for (i = 0; i < n; ++i) {
+            Gink::Stream stream;
+            stream.write(chunk.data(), size);
+            stream.read(nullptr, size / 3);
+            stream.shrinkToFit();
+            Gink::KeepValue(stream);
+        }
+    });
+}
+
+} // namespace
@@ -0,0 +1,44 @@
+#pragma once
+
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+#include "IPEndpoint.h"
+
+
+namespace Gink {
+
+class AddressCache final
+{
+    AddressCache(const AddressCache &) = delete;
+    void operator=(const AddressCache &) = delete;
+
+public:
+    static std::string MakeKey(const char *, const char *);
+
+    inline explicit AddressCache(int = 30000);
+
+    IPEndpoint resolve(const char *, const char *);
+    void invalidate(const char *, const char *);
+    void clear();
+
+private:
+    struct Entry
+    {
+        IPEndpoint endpoint;
+        std::chrono::steady_clock::time_point expiryTime;
+    };
+
+    const std::chrono::milliseconds timeToLive_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+
+AddressCache::AddressCache(int timeToLive)
+    : timeToLive_(timeToLive)
+{
+}
+
+} // namespace Gink
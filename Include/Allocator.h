@@ -0,0 +1,41 @@
+#pragma once
+
+
+#include <cstddef>
+
+
+namespace Gink {
+
+class Allocator
+{
+    Allocator(const Allocator &) = delete;
+    void operator=(const Allocator &) = delete;
+
+public:
+    virtual void *allocate(std::size_t) = 0;
+    virtual void deallocate(void *, std::size_t) noexcept = 0;
+    inline virtual std::size_t getBlockSize(std::size_t) const noexcept;
+
+protected:
+    inline explicit Allocator();
+    inline ~Allocator();
+};
+
+
+Allocator::Allocator()
+{
+}
+
+
+Allocator::~Allocator()
+{
+}
+
+
+std::size_t
+Allocator::getBlockSize(std::size_t size) const noexcept
+{
+    return size;
+}
+
+} // namespace Gink
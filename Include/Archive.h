@@ -3,17 +3,62 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <cassert>
 #include <type_traits>
 #include <vector>
 #include <string>
 #include <limits>
+#include <tuple>
+#include <utility>
+
+#include "BytesView.h"
+
+
+#define GINK_SERIALIZABLE(type, ...)                                                               \
+    void store(Gink::Archive *archive) const                                                       \
+    {                                                                                              \
+        static_assert(std::is_same<decltype(this), const type *>::value, "");                      \
+        archive->storeFields(__VA_ARGS__);                                                         \
+    }                                                                                              \
+                                                                                                   \
+    template<class T = Gink::SizeArchive>                                                          \
+    void store(T *archive) const                                                                   \
+    {                                                                                              \
+        archive->storeFields(__VA_ARGS__);                                                         \
+    }                                                                                              \
+                                                                                                   \
+    void load(Gink::Archive *archive)                                                              \
+    {                                                                                              \
+        archive->loadFields(__VA_ARGS__);                                                          \
+    }                                                                                              \
+                                                                                                   \
+    bool tryLoad(Gink::Archive *archive)                                                           \
+    {                                                                                              \
+        return archive->tryLoadFields(__VA_ARGS__);                                                \
+    }                                                                                              \
+                                                                                                   \
+    static void skip(Gink::Archive *archive)                                                       \
+    {                                                                                              \
+        archive->skipFields(static_cast<decltype(std::forward_as_tuple(__VA_ARGS__)) *>(nullptr)); \
+    }
 
 
 namespace Gink {
 
+class SizeArchive;
 class Stream;
 
+template<class T>
+class CompactInteger;
+
+
+enum class IntegerEncoding
+{
+    Fixed,
+    Compact,
+};
+
 
 class Archive final
 {
@@ -21,11 +66,14 @@ class Archive final
     Archive &operator=(Archive &) = delete;
 
 public:
-    inline explicit Archive(Stream *);
+    inline explicit Archive(Stream *, IntegerEncoding = IntegerEncoding::Fixed);
     inline Archive &operator<<(bool);
     inline Archive &operator>>(bool &);
     inline Archive &operator<<(const std::string &);
     inline Archive &operator>>(std::string &);
+    inline Archive &operator<<(const BytesView &);
+    // The view points into the stream and is invalidated by `flush()` or by any write.
+    inline Archive &operator>>(BytesView &);
 
     template<class T>
     inline typename std::enable_if<std::is_unsigned<T>::value, Archive &>::type operator<<(T);
@@ -34,10 +82,20 @@ public:
     inline typename std::enable_if<std::is_unsigned<T>::value, Archive &>::type operator>>(T &);
 
     template<class T>
-    inline typename std::enable_if<std::is_signed<T>::value, Archive &>::type operator<<(T);
+    inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value
+                                   , Archive &>::type operator<<(T);
+
+    template<class T>
+    inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value
+                                   , Archive &>::type operator>>(T &);
+
+    template<class T>
+    inline typename std::enable_if<std::is_floating_point<T>::value, Archive &>::type
+    operator<<(T);
 
     template<class T>
-    inline typename std::enable_if<std::is_signed<T>::value, Archive &>::type operator>>(T &);
+    inline typename std::enable_if<std::is_floating_point<T>::value, Archive &>::type
+    operator>>(T &);
 
     template<class T>
     inline typename std::enable_if<std::is_enum<T>::value, Archive &>::type operator<<(T);
@@ -51,6 +109,12 @@ public:
     template<class T>
     inline typename std::enable_if<std::is_class<T>::value, Archive &>::type operator>>(T &);
 
+    template<class T>
+    inline Archive &operator<<(CompactInteger<T>);
+
+    template<class T>
+    inline Archive &operator>>(CompactInteger<T>);
+
     template<class T, std::size_t N>
     inline Archive &operator<<(const T (&)[N]);
 
@@ -63,12 +127,56 @@ public:
     template<class T>
     inline Archive &operator>>(std::vector<T> &);
 
+    template<class... T>
+    inline void storeFields(const T &...);
+
+    template<class... T>
+    inline void loadFields(T &...);
+
+    template<class... T>
+    inline bool tryLoadFields(T &...);
+
+    template<class... T>
+    inline void skipFields(std::tuple<T &...> *);
+
+    template<class T>
+    inline void peek(T &);
+
+    // The view points into the stream and is invalidated by `flush()` or by any write.
+    template<class T>
+    inline BytesView skip();
+
+    // On a shortage of data, returns false instead of throwing and reports a lower bound on
+    // the number of bytes still missing. The fields of GINK_SERIALIZABLE types and the vector
+    // elements loaded so far are kept, and the next call, which must pass the same object,
+    // resumes after them. Any other value is loaded into a temporary and loaded again from
+    // its start.
+    template<class T>
+    inline bool tryLoad(T &, std::size_t * = nullptr);
+
+    void reserve(std::size_t);
     void flush();
 
 private:
+    struct Length
+    {
+        std::uintmax_t value;
+
+        void load(Archive *archive)
+        {
+            archive->deserializeVariableLengthInteger(&value);
+        }
+    };
+
     Stream *const stream_;
+    const bool isCompact_;
     std::size_t writtenByteCount_;
     std::size_t readByteCount_;
+    std::size_t missingByteCount_;
+    bool isTrying_;
+    const void *pendingObject_;
+    std::vector<std::size_t> checkpoints_;
+    std::size_t depth_;
 
     void serializeInteger(std::uint8_t);
     void deserializeInteger(std::uint8_t *);
@@ -78,20 +186,372 @@ private:
     void deserializeInteger(std::uint32_t *);
     void serializeInteger(std::uint64_t);
     void deserializeInteger(std::uint64_t *);
+    void serializeCompactInteger(std::uint64_t);
+    void deserializeCompactInteger(std::uint64_t *);
     void serializeVariableLengthInteger(std::uintmax_t);
     void deserializeVariableLengthInteger(std::uintmax_t *);
     void serializeBytes(const char *, std::size_t);
     void deserializeBytes(const char **, std::size_t *);
+    void serializeIntegers(const std::uint8_t *, std::size_t);
+    void deserializeIntegers(std::uint8_t *, std::size_t);
+    void serializeIntegers(const std::uint16_t *, std::size_t);
+    void deserializeIntegers(std::uint16_t *, std::size_t);
+    void serializeIntegers(const std::uint32_t *, std::size_t);
+    void deserializeIntegers(std::uint32_t *, std::size_t);
+    void serializeIntegers(const std::uint64_t *, std::size_t);
+    void deserializeIntegers(std::uint64_t *, std::size_t);
+    unsigned char *getBuffer(std::size_t);
+    const unsigned char *getData() const;
+    std::size_t getReadableSize() const;
+    void skipBytes(std::size_t);
+    void skipCompactInteger();
+    bool checkDataSize(std::size_t, std::size_t);
+    void handleNoData(std::size_t);
+    [[noreturn]] void handleBadData();
+
+    inline void skipValue(bool *);
+    inline void skipValue(std::string *);
+    inline void skipValue(BytesView *);
+
+    template<class T>
+    inline typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type
+    skipValue(T *);
+
+    template<class T>
+    inline typename std::enable_if<std::is_class<T>::value>::type skipValue(T *);
+
+    template<class T, std::size_t N>
+    inline void skipValue(T (*)[N]);
+
+    template<class T>
+    inline void skipValue(std::vector<T> *);
+
+    template<class T>
+    inline void skipElements(std::size_t, std::true_type);
+
+    template<class T>
+    inline void skipElements(std::size_t, std::false_type);
+
+    inline void storeRun();
+
+    template<class T, class... U>
+    inline void storeRun(const T &, const U &...);
+
+    template<class T, class... U>
+    inline void storeRun(std::false_type, const T &, const U &...);
+
+    template<class T, class... U>
+    inline void storeRun(std::true_type, const T &, const U &...);
+
+    template<class T, class... U>
+    inline void storeFixedRun(unsigned char *, const T &, const U &...);
+
+    template<class... T>
+    inline void continueFixedRun(std::false_type, unsigned char *, const T &...);
+
+    template<class... T>
+    inline void continueFixedRun(std::true_type, unsigned char *, const T &...);
+
+    inline void loadRun();
+
+    template<class T, class... U>
+    inline void loadRun(T &, U &...);
+
+    template<class T, class... U>
+    inline void loadRun(std::false_type, T &, U &...);
+
+    template<class T, class... U>
+    inline void loadRun(std::true_type, T &, U &...);
+
+    template<class T, class... U>
+    inline void loadFixedRun(const unsigned char *, T &, U &...);
+
+    template<class... T>
+    inline void continueFixedRun(std::false_type, const unsigned char *, T &...);
+
+    template<class... T>
+    inline void continueFixedRun(std::true_type, const unsigned char *, T &...);
+
+    static inline void EncodeFixed(unsigned char *, bool);
+    static inline void DecodeFixed(const unsigned char *, bool *);
+
+    template<class T>
+    static inline typename std::enable_if<std::is_unsigned<T>::value>::type
+    EncodeFixed(unsigned char *, T);
+
+    template<class T>
+    static inline typename std::enable_if<std::is_unsigned<T>::value>::type
+    DecodeFixed(const unsigned char *, T *);
+
+    template<class T>
+    static inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    EncodeFixed(unsigned char *, T);
+
+    template<class T>
+    static inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    DecodeFixed(const unsigned char *, T *);
+
+    template<class T>
+    static inline typename std::enable_if<std::is_floating_point<T>::value>::type
+    EncodeFixed(unsigned char *, T);
+
+    template<class T>
+    static inline typename std::enable_if<std::is_floating_point<T>::value>::type
+    DecodeFixed(const unsigned char *, T *);
+
+    template<class T>
+    static inline typename std::enable_if<std::is_enum<T>::value>::type
+    EncodeFixed(unsigned char *, T);
+
+    template<class T>
+    static inline typename std::enable_if<std::is_enum<T>::value>::type
+    DecodeFixed(const unsigned char *, T *);
+
+    template<class T>
+    inline typename std::enable_if<std::is_unsigned<T>::value>::type serializeCompact(T);
+
+    template<class T>
+    inline typename std::enable_if<std::is_unsigned<T>::value>::type deserializeCompact(T *);
+
+    template<class T>
+    inline typename std::enable_if<std::is_signed<T>::value>::type serializeCompact(T);
+
+    template<class T>
+    inline typename std::enable_if<std::is_signed<T>::value>::type deserializeCompact(T *);
+
+    template<class T>
+    inline bool tryLoadValue(T &, std::true_type);
+
+    template<class T>
+    inline bool tryLoadValue(std::vector<T> &, std::true_type);
+
+    template<class T>
+    inline bool tryLoadValue(T &, std::false_type);
+
+    template<class T>
+    inline bool tryLoadField(T &, std::size_t, std::size_t);
+
+    template<class T>
+    inline bool tryLoadElements(std::vector<T> &, std::size_t, std::true_type);
+
+    template<class T>
+    inline bool tryLoadElements(std::vector<T> &, std::size_t, std::false_type);
+
+    template<class T>
+    inline void serializeElements(const T *, std::size_t, std::true_type);
+
+    template<class T>
+    inline void deserializeElements(T *, std::size_t, std::true_type);
+
+    template<class T>
+    inline void serializeElements(const T *, std::size_t, std::false_type);
+
+    template<class T>
+    inline void deserializeElements(T *, std::size_t, std::false_type);
+
+    template<class T>
+    inline void serializeElements(const std::vector<T> &, std::true_type);
+
+    template<class T>
+    inline void deserializeElements(std::vector<T> &, std::size_t, std::true_type);
+
+    template<class T>
+    inline void serializeElements(const std::vector<T> &, std::false_type);
+
+    template<class T>
+    inline void deserializeElements(std::vector<T> &, std::size_t, std::false_type);
+
+    template<class T>
+    using FixedSize = std::integral_constant<std::size_t, std::is_arithmetic<T>::value
+                                                          || std::is_enum<T>::value ? sizeof(T) : 0>;
+
+    template<class... T>
+    struct RunSize;
+
+    template<class T>
+    using IsBulkElement = std::integral_constant<bool, std::is_arithmetic<T>::value
+                                                       && !std::is_same<T, bool>::value>;
+
+    template<class T, bool = std::is_floating_point<T>::value>
+    struct BulkInteger;
+
+    template<class T, class = void>
+    struct IsResumable;
+
+    template<class T>
+    inline bool isCompacted() const;
 };
 
 
-Archive::Archive(Stream *stream)
-    : stream_(stream), writtenByteCount_(0), readByteCount_(0)
+Archive::Archive(Stream *stream, IntegerEncoding integerEncoding)
+    : stream_(stream), isCompact_(integerEncoding == IntegerEncoding::Compact), writtenByteCount_(0)
+      , readByteCount_(0), missingByteCount_(0), isTrying_(false), pendingObject_(nullptr)
+      , depth_(0)
 {
     assert(stream != nullptr);
 }
 
 
+template<>
+struct Archive::RunSize<>
+    : std::integral_constant<std::size_t, 0>
+{
+};
+
+
+template<class T, class... U>
+struct Archive::RunSize<T, U...>
+    : std::integral_constant<std::size_t, FixedSize<T>::value == 0 ? 0
+                                          : FixedSize<T>::value + RunSize<U...>::value>
+{
+};
+
+
+template<class T>
+struct Archive::BulkInteger<T, false>
+{
+    typedef typename std::make_unsigned<T>::type Type;
+};
+
+
+template<class T>
+struct Archive::BulkInteger<T, true>
+{
+    typedef typename std::conditional<sizeof(T) == sizeof(std::uint32_t), std::uint32_t
+                                      , std::uint64_t>::type Type;
+
+    static_assert(sizeof(Type) == sizeof(T) && std::numeric_limits<T>::is_iec559, "");
+};
+
+
+template<class T, class>
+struct Archive::IsResumable
+    : std::false_type
+{
+};
+
+
+template<class T>
+struct Archive::IsResumable<T, decltype(std::declval<T &>().tryLoad(std::declval<Archive *>())
+                                        , void())>
+    : std::true_type
+{
+};
+
+
+template<class T>
+struct Archive::IsResumable<std::vector<T>, void>
+    : std::true_type
+{
+};
+
+
+template<class T>
+bool
+Archive::isCompacted() const
+{
+    typedef typename std::conditional<std::is_enum<T>::value, std::underlying_type<T>
+                                      , std::remove_cv<T>>::type::type U;
+    return isCompact_ && std::is_integral<U>::value && sizeof(U) >= 2;
+}
+
+
+template<class... T>
+void
+Archive::storeFields(const T &...fields)
+{
+    if (isCompact_) {
+        int dummy[] = {0, (operator<<(fields), 0)...};
+        static_cast<void>(dummy);
+        return;
+    }
+
+    storeRun(fields...);
+}
+
+
+template<class... T>
+void
+Archive::loadFields(T &...fields)
+{
+    if (isCompact_) {
+        int dummy[] = {0, (operator>>(fields), 0)...};
+        static_cast<void>(dummy);
+        return;
+    }
+
+    loadRun(fields...);
+}
+
+
+template<class... T>
+bool
+Archive::tryLoadFields(T &...fields)
+{
+    std::size_t depth = depth_++;
+
+    if (checkpoints_.size() == depth) {
+        checkpoints_.push_back(0);
+    }
+
+    std::size_t i = 0;
+    bool isLoaded = true;
+    int dummy[] = {0, (isLoaded = isLoaded && tryLoadField(fields, i++, depth), 0)...};
+    static_cast<void>(dummy);
+    --depth_;
+
+    if (isLoaded) {
+        checkpoints_.pop_back();
+    }
+
+    return isLoaded;
+}
+
+
+template<class... T>
+void
+Archive::skipFields(std::tuple<T &...> *)
+{
+    int dummy[] = {0, (skipValue(static_cast<typename std::remove_cv<T>::type *>(nullptr)), 0)...};
+    static_cast<void>(dummy);
+}
+
+
+template<class T>
+void
+Archive::peek(T &object)
+{
+    std::size_t readByteCount = readByteCount_;
+
+    try {
+        operator>>(object);
+    } catch (...) {
+        readByteCount_ = readByteCount;
+        throw;
+    }
+
+    readByteCount_ = readByteCount;
+}
+
+
+template<class T>
+BytesView
+Archive::skip()
+{
+    std::size_t readByteCount = readByteCount_;
+    auto data = reinterpret_cast<const char *>(getData());
+
+    try {
+        skipValue(static_cast<T *>(nullptr));
+    } catch (...) {
+        readByteCount_ = readByteCount;
+        throw;
+    }
+
+    return BytesView(data, readByteCount_ - readByteCount);
+}
+
+
 Archive &
 Archive::operator<<(bool boolean)
 {
@@ -129,11 +589,32 @@ Archive::operator>>(std::string &string)
 }
 
 
+Archive &
+Archive::operator<<(const BytesView &bytesView)
+{
+    serializeBytes(bytesView.data, bytesView.size);
+    return *this;
+}
+
+
+Archive &
+Archive::operator>>(BytesView &bytesView)
+{
+    deserializeBytes(&bytesView.data, &bytesView.size);
+    return *this;
+}
+
+
 template<class T>
 typename std::enable_if<std::is_unsigned<T>::value, Archive &>::type
 Archive::operator<<(T integer)
 {
-    serializeInteger(integer);
+    if (isCompacted<T>()) {
+        serializeCompact(integer);
+    } else {
+        serializeInteger(integer);
+    }
+
     return *this;
 }
 
@@ -142,24 +623,39 @@ template<class T>
 typename std::enable_if<std::is_unsigned<T>::value, Archive &>::type
 Archive::operator>>(T &integer)
 {
-    deserializeInteger(&integer);
+    if (isCompacted<T>()) {
+        deserializeCompact(&integer);
+    } else {
+        deserializeInteger(&integer);
+    }
+
     return *this;
 }
 
 
 template<class T>
-typename std::enable_if<std::is_signed<T>::value, Archive &>::type
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, Archive &>::type
 Archive::operator<<(T integer)
 {
-    serializeInteger(static_cast<typename std::make_unsigned<T>::type>(integer));
+    if (isCompacted<T>()) {
+        serializeCompact(integer);
+    } else {
+        serializeInteger(static_cast<typename std::make_unsigned<T>::type>(integer));
+    }
+
     return *this;
 }
 
 
 template<class T>
-typename std::enable_if<std::is_signed<T>::value, Archive &>::type
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, Archive &>::type
 Archive::operator>>(T &integer)
 {
+    if (isCompacted<T>()) {
+        deserializeCompact(&integer);
+        return *this;
+    }
+
     typename std::make_unsigned<T>::type temp;
     deserializeInteger(&temp);
     integer = temp <= std::numeric_limits<T>::max() ? static_cast<T>(temp)
@@ -168,6 +664,28 @@ Archive::operator>>(T &integer)
 }
 
 
+template<class T>
+typename std::enable_if<std::is_floating_point<T>::value, Archive &>::type
+Archive::operator<<(T number)
+{
+    typename BulkInteger<T>::Type temp;
+    std::memcpy(&temp, &number, sizeof temp);
+    serializeInteger(temp);
+    return *this;
+}
+
+
+template<class T>
+typename std::enable_if<std::is_floating_point<T>::value, Archive &>::type
+Archive::operator>>(T &number)
+{
+    typename BulkInteger<T>::Type temp;
+    deserializeInteger(&temp);
+    std::memcpy(&number, &temp, sizeof number);
+    return *this;
+}
+
+
 template<class T>
 typename std::enable_if<std::is_enum<T>::value, Archive &>::type
 Archive::operator<<(T enumerator)
@@ -206,46 +724,257 @@ Archive::operator>>(T &object)
 }
 
 
-template<class T, std::size_t N>
+template<class T>
 Archive &
-Archive::operator<<(const T (&array)[N])
+Archive::operator<<(CompactInteger<T> compactInteger)
 {
-    std::ptrdiff_t i;
+    serializeCompact(compactInteger.integer_);
+    return *this;
+}
 
-    for (i = 0; i < static_cast<std::ptrdiff_t>(N); ++i) {
-        operator<<(array[i]);
-    }
 
+template<class T>
+Archive &
+Archive::operator>>(CompactInteger<T> compactInteger)
+{
+    deserializeCompact(&compactInteger.integer_);
     return *this;
 }
 
 
 template<class T, std::size_t N>
 Archive &
-Archive::operator>>(T (&array)[N])
+Archive::operator<<(const T (&array)[N])
 {
-    std::ptrdiff_t i;
+    serializeElements(array, N, IsBulkElement<T>());
+    return *this;
+}
 
-    for (i = 0; i < static_cast<std::ptrdiff_t>(N); ++i) {
-        operator>>(array[i]);
-    }
 
+template<class T, std::size_t N>
+Archive &
+Archive::operator>>(T (&array)[N])
+{
+    deserializeElements(array, N, IsBulkElement<T>());
     return *this;
 }
 
 
 template<class T>
-Archive &
-Archive::operator<<(const std::vector<T> &vector)
+bool
+Archive::tryLoad(T &object, std::size_t *missingByteCount)
 {
-    serializeVariableLengthInteger(vector.size());
+    if (pendingObject_ != &object) {
+        checkpoints_.clear();
+    }
 
-    for (const T &x: vector) {
-        operator<<(x);
+    isTrying_ = true;
+    depth_ = 0;
+    bool isLoaded;
+
+    try {
+        isLoaded = tryLoadValue(object, IsResumable<T>());
+    } catch (...) {
+        isTrying_ = false;
+        missingByteCount_ = 0;
+        pendingObject_ = nullptr;
+        checkpoints_.clear();
+        throw;
     }
 
-    return *this;
-}
+    isTrying_ = false;
+
+    if (isLoaded) {
+        pendingObject_ = nullptr;
+        return true;
+    }
+
+    pendingObject_ = &object;
+
+    if (missingByteCount != nullptr) {
+        *missingByteCount = missingByteCount_;
+    }
+
+    missingByteCount_ = 0;
+    return false;
+}
+
+
+template<class T>
+typename std::enable_if<std::is_unsigned<T>::value>::type
+Archive::serializeCompact(T integer)
+{
+    serializeCompactInteger(integer);
+}
+
+
+template<class T>
+typename std::enable_if<std::is_unsigned<T>::value>::type
+Archive::deserializeCompact(T *integer)
+{
+    std::uint64_t temp;
+    deserializeCompactInteger(&temp);
+
+    if (static_cast<T>(temp) != temp) {
+        handleBadData();
+    }
+
+    *integer = static_cast<T>(temp);
+}
+
+
+template<class T>
+typename std::enable_if<std::is_signed<T>::value>::type
+Archive::serializeCompact(T integer)
+{
+    auto temp = static_cast<std::int64_t>(integer);
+    serializeCompactInteger(static_cast<std::uint64_t>(temp) << 1
+                            ^ static_cast<std::uint64_t>(temp >> 63));
+}
+
+
+template<class T>
+typename std::enable_if<std::is_signed<T>::value>::type
+Archive::deserializeCompact(T *integer)
+{
+    std::uint64_t temp;
+    deserializeCompactInteger(&temp);
+    auto value = static_cast<std::int64_t>(temp >> 1 ^ -(temp & 1));
+
+    if (static_cast<T>(value) != value) {
+        handleBadData();
+    }
+
+    *integer = static_cast<T>(value);
+}
+
+
+template<class T>
+bool
+Archive::tryLoadValue(T &object, std::true_type)
+{
+    return object.tryLoad(this);
+}
+
+
+template<class T>
+bool
+Archive::tryLoadValue(std::vector<T> &vector, std::true_type)
+{
+    std::size_t depth = depth_;
+
+    if (checkpoints_.size() == depth) {
+        Length length;
+
+        if (!tryLoadValue(length, std::false_type())) {
+            return false;
+        }
+
+        vector.clear();
+        checkpoints_.push_back(static_cast<std::size_t>(length.value));
+    }
+
+    ++depth_;
+    bool isLoaded = tryLoadElements(vector, depth, IsBulkElement<T>());
+    --depth_;
+
+    if (isLoaded) {
+        checkpoints_.pop_back();
+    }
+
+    return isLoaded;
+}
+
+
+template<class T>
+bool
+Archive::tryLoadValue(T &object, std::false_type)
+{
+    std::size_t readByteCount = readByteCount_;
+    T value{};
+    operator>>(value);
+
+    if (missingByteCount_ != 0) {
+        readByteCount_ = readByteCount;
+        return false;
+    }
+
+    using std::swap;
+    swap(object, value);
+    return true;
+}
+
+
+template<class T>
+bool
+Archive::tryLoadField(T &field, std::size_t i, std::size_t depth)
+{
+    if (i < checkpoints_[depth]) {
+        return true;
+    }
+
+    if (!tryLoadValue(field, IsResumable<T>())) {
+        return false;
+    }
+
+    checkpoints_[depth] = i + 1;
+    return true;
+}
+
+
+template<class T>
+bool
+Archive::tryLoadElements(std::vector<T> &vector, std::size_t depth, std::true_type)
+{
+    if (isCompacted<T>()) {
+        return tryLoadElements(vector, depth, std::false_type());
+    }
+
+    typedef typename BulkInteger<T>::Type U;
+    std::size_t n = getReadableSize() / sizeof(U);
+
+    if (n > checkpoints_[depth]) {
+        n = checkpoints_[depth];
+    }
+
+    std::size_t i = vector.size();
+    vector.resize(i + n);
+    deserializeIntegers(reinterpret_cast<U *>(vector.data() + i), n);
+    checkpoints_[depth] -= n;
+    return checkDataSize(checkpoints_[depth], sizeof(U));
+}
+
+
+template<class T>
+bool
+Archive::tryLoadElements(std::vector<T> &vector, std::size_t depth, std::false_type)
+{
+    for (; checkpoints_[depth] >= 1; --checkpoints_[depth]) {
+        if (checkpoints_.size() == depth + 1) {
+            vector.emplace_back();
+        }
+
+        if (!tryLoadValue(vector.back(), IsResumable<T>())) {
+            if (checkpoints_.size() == depth + 1) {
+                vector.pop_back();
+            }
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+template<class T>
+Archive &
+Archive::operator<<(const std::vector<T> &vector)
+{
+    serializeVariableLengthInteger(vector.size());
+    serializeElements(vector, IsBulkElement<T>());
+    return *this;
+}
 
 
 template<class T>
@@ -255,14 +984,726 @@ Archive::operator>>(std::vector<T> &vector)
     std::uintmax_t temp;
     deserializeVariableLengthInteger(&temp);
     auto n = static_cast<typename std::vector<T>::size_type>(temp);
+    deserializeElements(vector, n, IsBulkElement<T>());
+    return *this;
+}
+
+
+template<class T>
+void
+Archive::serializeElements(const T *elements, std::size_t n, std::true_type)
+{
+    if (isCompacted<T>()) {
+        serializeElements(elements, n, std::false_type());
+        return;
+    }
+
+    typedef typename BulkInteger<T>::Type U;
+    serializeIntegers(reinterpret_cast<const U *>(elements), n);
+}
+
+
+template<class T>
+void
+Archive::deserializeElements(T *elements, std::size_t n, std::true_type)
+{
+    if (isCompacted<T>()) {
+        deserializeElements(elements, n, std::false_type());
+        return;
+    }
+
+    typedef typename BulkInteger<T>::Type U;
+    deserializeIntegers(reinterpret_cast<U *>(elements), n);
+}
+
+
+template<class T>
+void
+Archive::serializeElements(const T *elements, std::size_t n, std::false_type)
+{
+    std::size_t i;
+
+    for (i = 0; i < n; ++i) {
+        operator<<(elements[i]);
+    }
+}
+
+
+template<class T>
+void
+Archive::deserializeElements(T *elements, std::size_t n, std::false_type)
+{
+    std::size_t i;
+
+    for (i = 0; i < n; ++i) {
+        operator>>(elements[i]);
+    }
+}
+
+
+template<class T>
+void
+Archive::serializeElements(const std::vector<T> &vector, std::true_type)
+{
+    if (isCompacted<T>()) {
+        serializeElements(vector, std::false_type());
+        return;
+    }
+
+    serializeElements(vector.data(), vector.size(), std::true_type());
+}
+
+
+template<class T>
+void
+Archive::deserializeElements(std::vector<T> &vector, std::size_t n, std::true_type)
+{
+    if (isCompacted<T>()) {
+        if (checkDataSize(n, 1)) {
+            deserializeElements(vector, n, std::false_type());
+        }
+
+        return;
+    }
+
+    typedef typename BulkInteger<T>::Type U;
+
+    if (!checkDataSize(n, sizeof(U))) {
+        return;
+    }
+
+    std::size_t i = vector.size();
+    vector.resize(i + n);
+    deserializeElements(vector.data() + i, n, std::true_type());
+}
+
+
+template<class T>
+void
+Archive::serializeElements(const std::vector<T> &vector, std::false_type)
+{
+    for (const T &x: vector) {
+        operator<<(x);
+    }
+}
 
-    while (n >= 1) {
+
+template<class T>
+void
+Archive::deserializeElements(std::vector<T> &vector, std::size_t n, std::false_type)
+{
+    while (n >= 1 && missingByteCount_ == 0) {
         vector.emplace_back();
         operator>>(vector.back());
         --n;
     }
+}
+
+
+void
+Archive::skipValue(bool *)
+{
+    skipBytes(1);
+}
+
+
+void
+Archive::skipValue(std::string *)
+{
+    Length length;
+    operator>>(length);
+    skipBytes(length.value);
+}
+
+
+void
+Archive::skipValue(BytesView *)
+{
+    skipValue(static_cast<std::string *>(nullptr));
+}
+
+
+template<class T>
+typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type
+Archive::skipValue(T *)
+{
+    if (isCompacted<T>()) {
+        skipCompactInteger();
+    } else {
+        skipBytes(sizeof(T));
+    }
+}
+
+
+template<class T>
+typename std::enable_if<std::is_class<T>::value>::type
+Archive::skipValue(T *)
+{
+    T::skip(this);
+}
+
+
+template<class T, std::size_t N>
+void
+Archive::skipValue(T (*)[N])
+{
+    skipElements<T>(N, std::integral_constant<bool, (FixedSize<T>::value >= 1)>());
+}
+
+
+template<class T>
+void
+Archive::skipValue(std::vector<T> *)
+{
+    Length length;
+    operator>>(length);
+    skipElements<T>(length.value, std::integral_constant<bool, (FixedSize<T>::value >= 1)>());
+}
+
+
+template<class T>
+void
+Archive::skipElements(std::size_t n, std::true_type)
+{
+    if (isCompacted<T>()) {
+        skipElements<T>(n, std::false_type());
+        return;
+    }
+
+    if (checkDataSize(n, sizeof(T))) {
+        readByteCount_ += n * sizeof(T);
+    }
+}
+
+
+template<class T>
+void
+Archive::skipElements(std::size_t n, std::false_type)
+{
+    while (n >= 1 && missingByteCount_ == 0) {
+        skipValue(static_cast<T *>(nullptr));
+        --n;
+    }
+}
+
+
+void
+Archive::storeRun()
+{
+}
+
+
+template<class T, class... U>
+void
+Archive::storeRun(const T &field, const U &...fields)
+{
+    storeRun(std::integral_constant<bool, (FixedSize<T>::value >= 1)>(), field, fields...);
+}
+
+
+template<class T, class... U>
+void
+Archive::storeRun(std::false_type, const T &field, const U &...fields)
+{
+    operator<<(field);
+    storeRun(fields...);
+}
+
+
+template<class T, class... U>
+void
+Archive::storeRun(std::true_type, const T &field, const U &...fields)
+{
+    std::size_t runSize = RunSize<T, U...>::value;
+    unsigned char *buffer = getBuffer(runSize);
+    writtenByteCount_ += runSize;
+    storeFixedRun(buffer, field, fields...);
+}
+
+
+template<class T, class... U>
+void
+Archive::storeFixedRun(unsigned char *buffer, const T &field, const U &...fields)
+{
+    EncodeFixed(buffer, field);
+    continueFixedRun(std::integral_constant<bool, (RunSize<U...>::value >= 1)>()
+                     , buffer + sizeof(T), fields...);
+}
+
+
+template<class... T>
+void
+Archive::continueFixedRun(std::false_type, unsigned char *, const T &...fields)
+{
+    storeRun(fields...);
+}
+
+
+template<class... T>
+void
+Archive::continueFixedRun(std::true_type, unsigned char *buffer, const T &...fields)
+{
+    storeFixedRun(buffer, fields...);
+}
+
+
+void
+Archive::loadRun()
+{
+}
+
+
+template<class T, class... U>
+void
+Archive::loadRun(T &field, U &...fields)
+{
+    loadRun(std::integral_constant<bool, (FixedSize<T>::value >= 1)>(), field, fields...);
+}
+
+
+template<class T, class... U>
+void
+Archive::loadRun(std::false_type, T &field, U &...fields)
+{
+    operator>>(field);
+    loadRun(fields...);
+}
+
+
+template<class T, class... U>
+void
+Archive::loadRun(std::true_type, T &field, U &...fields)
+{
+    std::size_t runSize = RunSize<T, U...>::value;
+
+    if (!checkDataSize(runSize, 1)) {
+        return;
+    }
+
+    const unsigned char *data = getData();
+    readByteCount_ += runSize;
+    loadFixedRun(data, field, fields...);
+}
+
+
+template<class T, class... U>
+void
+Archive::loadFixedRun(const unsigned char *data, T &field, U &...fields)
+{
+    DecodeFixed(data, &field);
+    continueFixedRun(std::integral_constant<bool, (RunSize<U...>::value >= 1)>()
+                     , data + sizeof(T), fields...);
+}
+
+
+template<class... T>
+void
+Archive::continueFixedRun(std::false_type, const unsigned char *, T &...fields)
+{
+    loadRun(fields...);
+}
+
+
+template<class... T>
+void
+Archive::continueFixedRun(std::true_type, const unsigned char *data, T &...fields)
+{
+    loadFixedRun(data, fields...);
+}
+
+
+void
+Archive::EncodeFixed(unsigned char *buffer, bool boolean)
+{
+    buffer[0] = boolean;
+}
+
+
+void
+Archive::DecodeFixed(const unsigned char *data, bool *boolean)
+{
+    *boolean = data[0];
+}
+
+
+template<class T>
+typename std::enable_if<std::is_unsigned<T>::value>::type
+Archive::EncodeFixed(unsigned char *buffer, T integer)
+{
+    buffer[sizeof integer - 1] = integer;
+    std::ptrdiff_t i;
+
+    for (i = sizeof integer - 2; i >= 0; --i) {
+        integer >>= std::numeric_limits<unsigned char>::digits;
+        buffer[i] = integer;
+    }
+}
+
+
+template<class T>
+typename std::enable_if<std::is_unsigned<T>::value>::type
+Archive::DecodeFixed(const unsigned char *data, T *integer)
+{
+    *integer = data[0];
+    std::ptrdiff_t i;
+
+    for (i = 1; i < static_cast<std::ptrdiff_t>(sizeof *integer); ++i) {
+        *integer = *integer << std::numeric_limits<unsigned char>::digits | data[i];
+    }
+}
+
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+Archive::EncodeFixed(unsigned char *buffer, T integer)
+{
+    EncodeFixed(buffer, static_cast<typename std::make_unsigned<T>::type>(integer));
+}
+
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+Archive::DecodeFixed(const unsigned char *data, T *integer)
+{
+    typename std::make_unsigned<T>::type temp;
+    DecodeFixed(data, &temp);
+    *integer = temp <= std::numeric_limits<T>::max() ? static_cast<T>(temp)
+                                                       : -static_cast<T>(-temp - 1) - 1;
+}
+
+
+template<class T>
+typename std::enable_if<std::is_floating_point<T>::value>::type
+Archive::EncodeFixed(unsigned char *buffer, T number)
+{
+    typename BulkInteger<T>::Type temp;
+    std::memcpy(&temp, &number, sizeof temp);
+    EncodeFixed(buffer, temp);
+}
+
+
+template<class T>
+typename std::enable_if<std::is_floating_point<T>::value>::type
+Archive::DecodeFixed(const unsigned char *data, T *number)
+{
+    typename BulkInteger<T>::Type temp;
+    DecodeFixed(data, &temp);
+    std::memcpy(number, &temp, sizeof *number);
+}
+
+
+template<class T>
+typename std::enable_if<std::is_enum<T>::value>::type
+Archive::EncodeFixed(unsigned char *buffer, T enumerator)
+{
+    EncodeFixed(buffer, static_cast<typename std::underlying_type<T>::type>(enumerator));
+}
+
+
+template<class T>
+typename std::enable_if<std::is_enum<T>::value>::type
+Archive::DecodeFixed(const unsigned char *data, T *enumerator)
+{
+    typename std::underlying_type<T>::type temp;
+    DecodeFixed(data, &temp);
+    *enumerator = static_cast<T>(temp);
+}
+
+
+// Counts the bytes an Archive would write for the same values, so that the real Archive can
+// reserve its buffer once. Class types need a `store(SizeArchive *)` overload, which
+// GINK_SERIALIZABLE provides.
+class SizeArchive final
+{
+    SizeArchive(const SizeArchive &) = delete;
+    void operator=(const SizeArchive &) = delete;
+
+public:
+    template<class T>
+    static inline std::size_t Measure(const T &, IntegerEncoding = IntegerEncoding::Fixed);
+
+    inline explicit SizeArchive(IntegerEncoding = IntegerEncoding::Fixed);
+
+    inline std::size_t getSize() const;
+    inline SizeArchive &operator<<(bool);
+    inline SizeArchive &operator<<(const std::string &);
+    inline SizeArchive &operator<<(const BytesView &);
+
+    template<class T>
+    inline typename std::enable_if<std::is_integral<T>::value, SizeArchive &>::type operator<<(T);
+
+    template<class T>
+    inline typename std::enable_if<std::is_floating_point<T>::value, SizeArchive &>::type
+    operator<<(T);
+
+    template<class T>
+    inline typename std::enable_if<std::is_enum<T>::value, SizeArchive &>::type operator<<(T);
+
+    template<class T>
+    inline typename std::enable_if<std::is_class<T>::value, SizeArchive &>::type
+    operator<<(const T &);
+
+    template<class T>
+    inline SizeArchive &operator<<(CompactInteger<T>);
+
+    template<class T, std::size_t N>
+    inline SizeArchive &operator<<(const T (&)[N]);
+
+    template<class T>
+    inline SizeArchive &operator<<(const std::vector<T> &);
+
+    template<class... T>
+    inline void storeFields(const T &...);
+
+private:
+    const bool isCompact_;
+    std::size_t size_;
+
+    template<class T>
+    using IsFixedSize = std::integral_constant<bool, std::is_arithmetic<T>::value
+                                                     || std::is_enum<T>::value>;
+
+    template<class T>
+    inline bool isCompacted() const;
+
+    template<class T>
+    inline void addCompact(T);
+
+    template<class T, class U>
+    inline void addElements(const U &, std::size_t, std::true_type);
+
+    template<class T, class U>
+    inline void addElements(const U &, std::size_t, std::false_type);
+
+    inline void addVariableLengthInteger(std::uintmax_t);
+};
+
+
+template<class T>
+std::size_t
+SizeArchive::Measure(const T &object, IntegerEncoding integerEncoding)
+{
+    SizeArchive instance(integerEncoding);
+    instance << object;
+    return instance.size_;
+}
+
+
+SizeArchive::SizeArchive(IntegerEncoding integerEncoding)
+    : isCompact_(integerEncoding == IntegerEncoding::Compact), size_(0)
+{
+}
+
+
+std::size_t
+SizeArchive::getSize() const
+{
+    return size_;
+}
+
+
+SizeArchive &
+SizeArchive::operator<<(bool)
+{
+    size_ += 1;
+    return *this;
+}
+
+
+SizeArchive &
+SizeArchive::operator<<(const std::string &string)
+{
+    addVariableLengthInteger(string.size());
+    size_ += string.size();
+    return *this;
+}
+
+
+SizeArchive &
+SizeArchive::operator<<(const BytesView &bytesView)
+{
+    addVariableLengthInteger(bytesView.size);
+    size_ += bytesView.size;
+    return *this;
+}
+
+
+template<class T>
+typename std::enable_if<std::is_integral<T>::value, SizeArchive &>::type
+SizeArchive::operator<<(T integer)
+{
+    if (isCompacted<T>()) {
+        addCompact(integer);
+    } else {
+        size_ += sizeof integer;
+    }
+
+    return *this;
+}
 
+
+template<class T>
+typename std::enable_if<std::is_floating_point<T>::value, SizeArchive &>::type
+SizeArchive::operator<<(T number)
+{
+    size_ += sizeof number;
+    return *this;
+}
+
+
+template<class T>
+typename std::enable_if<std::is_enum<T>::value, SizeArchive &>::type
+SizeArchive::operator<<(T enumerator)
+{
+    return operator<<(static_cast<typename std::underlying_type<T>::type>(enumerator));
+}
+
+
+template<class T>
+typename std::enable_if<std::is_class<T>::value, SizeArchive &>::type
+SizeArchive::operator<<(const T &object)
+{
+    object.store(this);
     return *this;
 }
 
+
+template<class T>
+SizeArchive &
+SizeArchive::operator<<(CompactInteger<T> compactInteger)
+{
+    addCompact(compactInteger.integer_);
+    return *this;
+}
+
+
+template<class T, std::size_t N>
+SizeArchive &
+SizeArchive::operator<<(const T (&array)[N])
+{
+    addElements<T>(array, N, IsFixedSize<T>());
+    return *this;
+}
+
+
+template<class T>
+SizeArchive &
+SizeArchive::operator<<(const std::vector<T> &vector)
+{
+    addVariableLengthInteger(vector.size());
+    addElements<T>(vector, vector.size(), IsFixedSize<T>());
+    return *this;
+}
+
+
+template<class... T>
+void
+SizeArchive::storeFields(const T &...fields)
+{
+    int dummy[] = {0, (operator<<(fields), 0)...};
+    static_cast<void>(dummy);
+}
+
+
+template<class T>
+bool
+SizeArchive::isCompacted() const
+{
+    return isCompact_ && (std::is_integral<T>::value || std::is_enum<T>::value) && sizeof(T) >= 2;
+}
+
+
+template<class T>
+void
+SizeArchive::addCompact(T integer)
+{
+    auto temp = static_cast<std::uint64_t>(integer);
+
+    if (std::is_signed<T>::value) {
+        temp = temp << 1 ^ static_cast<std::uint64_t>(static_cast<std::int64_t>(integer) >> 63);
+    }
+
+    int k = std::numeric_limits<std::uint64_t>::digits - __builtin_clzll(temp | 1);
+    size_ += k > 56 ? 9 : (k + 6) / 7;
+}
+
+
+template<class T, class U>
+void
+SizeArchive::addElements(const U &elements, std::size_t n, std::true_type)
+{
+    if (isCompacted<T>()) {
+        addElements<T>(elements, n, std::false_type());
+    } else {
+        size_ += n * sizeof(T);
+    }
+}
+
+
+template<class T, class U>
+void
+SizeArchive::addElements(const U &elements, std::size_t n, std::false_type)
+{
+    std::size_t i;
+
+    for (i = 0; i < n; ++i) {
+        operator<<(elements[i]);
+    }
+}
+
+
+void
+SizeArchive::addVariableLengthInteger(std::uintmax_t integer)
+{
+    std::uintmax_t temp = (integer ^ integer << 1) >> 1;
+
+    if (temp >> 6 == 0) {
+        size_ += 1;
+    } else if (temp >> 13 == 0) {
+        size_ += 2;
+    } else if (temp >> 28 == 0) {
+        size_ += 4;
+    } else if (temp >> 59 == 0) {
+        size_ += 8;
+    } else {
+        size_ += 9;
+    }
+}
+
+
+template<class T>
+class CompactInteger final
+{
+    void operator=(const CompactInteger &) = delete;
+
+public:
+    inline explicit CompactInteger(T &);
+
+private:
+    T &integer_;
+
+    friend Archive;
+    friend SizeArchive;
+};
+
+
+template<class T>
+inline CompactInteger<T> Compact(T &);
+
+
+template<class T>
+CompactInteger<T>::CompactInteger(T &integer)
+    : integer_(integer)
+{
+    static_assert(std::is_integral<T>::value, "");
+}
+
+
+template<class T>
+CompactInteger<T>
+Compact(T &integer)
+{
+    return CompactInteger<T>(integer);
+}
+
 } // namespace Gink
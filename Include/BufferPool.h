@@ -0,0 +1,61 @@
+#pragma once
+
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include "Allocator.h"
+
+
+namespace Gink {
+
+class BufferPool final: public Allocator
+{
+public:
+    struct Statistics
+    {
+        std::size_t numberOfHits;
+        std::size_t numberOfMisses;
+        double hitRate;
+        std::size_t residentByteCount;
+        std::size_t cachedByteCount;
+    };
+
+    static BufferPool *GetInstance();
+
+    void *allocate(std::size_t) override;
+    void deallocate(void *, std::size_t) noexcept override;
+    std::size_t getBlockSize(std::size_t) const noexcept override;
+    void setMaxCachedByteCount(std::size_t);
+    void trim();
+    Statistics getStatistics() const;
+
+private:
+    struct Block;
+    struct FreeList;
+    struct ThreadCache;
+
+    static constexpr int MinSizeClass = 4;
+    static constexpr int MaxSizeClass = 24;
+    static constexpr int NumberOfSizeClasses = MaxSizeClass - MinSizeClass + 1;
+
+    std::mutex mutex_;
+    std::size_t maxCachedByteCount_;
+    std::size_t sharedCachedByteCount_;
+    FreeList *sharedFreeLists_;
+    std::atomic<std::size_t> numberOfHits_;
+    std::atomic<std::size_t> numberOfMisses_;
+    std::atomic<std::size_t> residentByteCount_;
+    std::atomic<std::size_t> cachedByteCount_;
+
+    static ThreadCache *GetThreadCache();
+    static int GetSizeClass(std::size_t);
+
+    explicit BufferPool();
+
+    void *allocateShared(int);
+    void deallocateShared(void *, int) noexcept;
+};
+
+} // namespace Gink
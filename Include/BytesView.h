@@ -0,0 +1,64 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+
+namespace Gink {
+
+struct BytesView
+{
+    inline explicit BytesView();
+    inline explicit BytesView(const char *, std::size_t);
+    inline explicit BytesView(const std::string &);
+
+    inline bool operator==(const BytesView &) const;
+    inline bool operator!=(const BytesView &) const;
+    inline std::string toString() const;
+
+    const char *data;
+    std::size_t size;
+};
+
+
+BytesView::BytesView()
+    : data(nullptr), size(0)
+{
+}
+
+
+BytesView::BytesView(const char *data, std::size_t size)
+    : data(data), size(size)
+{
+}
+
+
+BytesView::BytesView(const std::string &string)
+    : data(string.data()), size(string.size())
+{
+}
+
+
+bool
+BytesView::operator==(const BytesView &other) const
+{
+    return size == other.size && (size == 0 || std::memcmp(data, other.data, size) == 0);
+}
+
+
+bool
+BytesView::operator!=(const BytesView &other) const
+{
+    return !operator==(other);
+}
+
+
+std::string
+BytesView::toString() const
+{
+    return std::string(data, size);
+}
+
+} // namespace Gink
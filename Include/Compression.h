@@ -0,0 +1,56 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace Gink {
+
+class Stream;
+
+
+class Compressor final
+{
+    Compressor(const Compressor &) = delete;
+    void operator=(const Compressor &) = delete;
+
+public:
+    inline explicit Compressor(std::size_t = 0);
+
+    void compress(Stream *, Stream *);
+
+private:
+    const std::size_t threshold_;
+    std::uint32_t hashTable_[4096];
+
+    std::size_t compressBlock(const unsigned char *, std::size_t, unsigned char *);
+};
+
+
+class Decompressor final
+{
+    Decompressor(const Decompressor &) = delete;
+    void operator=(const Decompressor &) = delete;
+
+public:
+    inline explicit Decompressor();
+
+    bool decompress(Stream *, Stream *);
+
+private:
+    void decompressBlock(const unsigned char *, std::size_t, unsigned char *, std::size_t);
+};
+
+
+Compressor::Compressor(std::size_t threshold)
+    : threshold_(threshold)
+{
+}
+
+
+Decompressor::Decompressor()
+{
+}
+
+} // namespace Gink
@@ -0,0 +1,118 @@
+#pragma once
+
+
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "AddressCache.h"
+#include "TCPSocket.h"
+#include "TimedEvent.h"
+
+
+namespace Gink {
+
+class ConnectionPool final
+{
+    ConnectionPool(const ConnectionPool &) = delete;
+    void operator=(const ConnectionPool &) = delete;
+
+public:
+    class Lease;
+
+    inline explicit ConnectionPool(std::size_t = 16, int = 60000, int = 30000);
+
+    Lease acquire(const char *, const char *, int = -1);
+    void removeIdleConnections();
+
+private:
+    struct IdleConnection
+    {
+        TCPSocket socket;
+        std::chrono::steady_clock::time_point releaseTime;
+    };
+
+    struct Endpoint
+    {
+        std::deque<IdleConnection> idleConnections;
+        std::size_t numberOfConnections;
+        TimedEvent event;
+
+        explicit Endpoint();
+    };
+
+    const std::size_t maxNumberOfConnections_;
+    const std::chrono::milliseconds maxIdleTime_;
+    AddressCache addressCache_;
+    std::unordered_map<std::string, Endpoint> endpoints_;
+
+    void release(Endpoint *, TCPSocket &&, bool);
+    void removeIdleConnections(Endpoint *, std::chrono::steady_clock::time_point);
+};
+
+
+class ConnectionPool::Lease final
+{
+    Lease(const Lease &) = delete;
+    void operator=(const Lease &) = delete;
+
+public:
+    inline Lease(Lease &&);
+
+    ~Lease();
+
+    inline const TCPSocket &getSocket() const;
+    inline void discard();
+
+private:
+    ConnectionPool *pool_;
+    Endpoint *endpoint_;
+    TCPSocket socket_;
+    bool isReusable_;
+
+    inline explicit Lease(ConnectionPool *, Endpoint *, TCPSocket &&);
+
+    friend ConnectionPool;
+};
+
+
+ConnectionPool::ConnectionPool(std::size_t maxNumberOfConnections, int maxIdleTime
+                               , int addressTimeToLive)
+    : maxNumberOfConnections_(maxNumberOfConnections), maxIdleTime_(maxIdleTime)
+      , addressCache_(addressTimeToLive)
+{
+}
+
+
+ConnectionPool::Lease::Lease(ConnectionPool *pool, Endpoint *endpoint, TCPSocket &&socket)
+    : pool_(pool), endpoint_(endpoint), socket_(std::move(socket)), isReusable_(true)
+{
+}
+
+
+ConnectionPool::Lease::Lease(Lease &&other)
+    : pool_(other.pool_), endpoint_(other.endpoint_), socket_(std::move(other.socket_))
+      , isReusable_(other.isReusable_)
+{
+    other.pool_ = nullptr;
+}
+
+
+const TCPSocket &
+ConnectionPool::Lease::getSocket() const
+{
+    return socket_;
+}
+
+
+void
+ConnectionPool::Lease::discard()
+{
+    isReusable_ = false;
+}
+
+} // namespace Gink
@@ -0,0 +1,43 @@
+#pragma once
+
+
+#include <chrono>
+
+
+namespace Gink {
+
+// Spreads one timeout in milliseconds over several waits. A negative timeout never expires and
+// a zero one has always expired.
+class Deadline final
+{
+public:
+    inline explicit Deadline(int);
+
+    inline int getRemainingTime() const;
+
+private:
+    const int timeout_;
+    const std::chrono::steady_clock::time_point time_;
+};
+
+
+Deadline::Deadline(int timeout)
+    : timeout_(timeout)
+      , time_(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout))
+{
+}
+
+
+int
+Deadline::getRemainingTime() const
+{
+    if (timeout_ <= 0) {
+        return timeout_;
+    }
+
+    auto remainingTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        time_ - std::chrono::steady_clock::now()).count();
+    return remainingTime <= 0 ? 0 : remainingTime;
+}
+
+} // namespace Gink
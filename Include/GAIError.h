@@ -23,19 +23,21 @@ public:
     inline ~GAIError() override;
 
     inline int getErrorCode() const noexcept;
-    inline const char *what() const noexcept override;
+    const char *what() const noexcept override;
 
+    // Like SystemError, the location must be a string literal.
     explicit GAIError(int, const char *);
 
 private:
     int errorCode_;
-    std::string description_;
+    const char *location_;
+    mutable std::string description_;
 };
 
 
 GAIError::GAIError(GAIError &&other)
     : std::exception(std::move(other)), errorCode_(other.errorCode_)
-      , description_(std::move(other.description_))
+      , location_(other.location_), description_(std::move(other.description_))
 {
 }
 
@@ -51,11 +53,4 @@ GAIError::getErrorCode() const noexcept
     return errorCode_;
 }
 
-
-const char *
-GAIError::what() const noexcept
-{
-    return description_.c_str();
-}
-
 } // namespace Gink
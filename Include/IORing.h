@@ -0,0 +1,80 @@
+#pragma once
+
+
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <Pixy/Event.h>
+
+
+namespace Gink {
+
+class IORing final
+{
+    IORing(const IORing &) = delete;
+    void operator=(const IORing &) = delete;
+
+public:
+    static IORing *GetInstance();
+    static ::ssize_t Read(int, void *, std::size_t, int);
+    static ::ssize_t ReadV(int, const ::iovec *, int, int);
+    static ::ssize_t Write(int, const void *, std::size_t, int);
+    static ::ssize_t WriteV(int, const ::iovec *, int, int);
+    static int Accept4(int, ::sockaddr *, ::socklen_t *, int, int);
+
+    ~IORing();
+
+    void registerBuffers(const ::iovec *, int);
+    void unregisterBuffers();
+
+private:
+    struct Request;
+
+    static constexpr unsigned NumberOfEntries = 256;
+
+    const int fd_;
+    int eventFD_;
+    void *sqRing_;
+    std::size_t sqRingSize_;
+    void *cqRing_;
+    std::size_t cqRingSize_;
+    ::io_uring_sqe *sqes_;
+    std::size_t sqesSize_;
+    unsigned *sqHead_;
+    unsigned *sqTail_;
+    unsigned *sqFlags_;
+    unsigned *sqArray_;
+    unsigned sqMask_;
+    unsigned sqEntries_;
+    unsigned sqLocalTail_;
+    unsigned *cqHead_;
+    unsigned *cqTail_;
+    unsigned cqMask_;
+    ::io_uring_cqe *cqes_;
+    unsigned numberOfPendingSQEs_;
+    ::Event flushEvent_;
+    std::vector<::iovec> registeredBuffers_;
+
+    static std::unique_ptr<IORing> Create();
+
+    explicit IORing(int, const ::io_uring_params &);
+
+    int execute(const ::io_uring_sqe &, int);
+    ::io_uring_sqe *pushSQE();
+    int reserveSQEs(unsigned);
+    int flush();
+    void discardSQEs(int);
+    void reap();
+    void completeRequest(Request *, int);
+    void runReaper();
+    void runFlusher();
+    int findRegisteredBuffer(const void *, std::size_t) const;
+};
+
+} // namespace Gink
@@ -4,6 +4,7 @@
 #include <netinet/in.h>
 
 #include <cstdint>
+#include <cstring>
 
 
 namespace Gink {
@@ -14,6 +15,7 @@ struct IPEndpoint
     inline explicit IPEndpoint(const ::sockaddr_in &);
 
     inline void set(const ::sockaddr_in &);
+    inline void get(::sockaddr_in *) const;
 
     std::uint32_t address;
     std::uint16_t portNumber;
@@ -39,4 +41,14 @@ IPEndpoint::set(const ::sockaddr_in &name)
     portNumber = ntohs(name.sin_port);
 }
 
+
+void
+IPEndpoint::get(::sockaddr_in *name) const
+{
+    std::memset(name, 0, sizeof *name);
+    name->sin_family = AF_INET;
+    name->sin_addr.s_addr = htonl(address);
+    name->sin_port = htons(portNumber);
+}
+
 } // namespace Gink
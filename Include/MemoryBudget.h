@@ -0,0 +1,65 @@
+#pragma once
+
+
+#include <cstddef>
+
+#include "Allocator.h"
+#include "TimedEvent.h"
+
+
+namespace Gink {
+
+// `allocate()` runs in the middle of encoding into a Stream, so it never yields: past the
+// limit it throws SystemError(ENOBUFS), or succeeds anyway if over-commit is allowed. Writers
+// apply back-pressure with `waitForRoom()` before they start encoding; it throws
+// SystemError(ETIMEDOUT) once its timeout expires. A budget, and the Streams allocating from it,
+// belong to a single thread.
+//
+// Blocks are charged at the size the upstream allocator really holds, e.g. a BufferPool size
+// class. A growing Stream holds its old and new buffers at once, so with a limit of N a single
+// Stream reaches only about 2N/3 bytes before growth fails.
+class MemoryBudget final: public Allocator
+{
+public:
+    explicit MemoryBudget(std::size_t, Allocator * = nullptr, bool = false);
+
+    inline std::size_t getLimit() const;
+    inline std::size_t getUsedByteCount() const;
+    inline bool hasRoom(std::size_t) const;
+
+    void *allocate(std::size_t) override;
+    void deallocate(void *, std::size_t) noexcept override;
+    std::size_t getBlockSize(std::size_t) const noexcept override;
+    void setLimit(std::size_t);
+    void waitForRoom(std::size_t, int = -1);
+
+private:
+    Allocator *const upstream_;
+    const bool allowsOvercommit_;
+    std::size_t limit_;
+    std::size_t usedByteCount_;
+    TimedEvent event_;
+};
+
+
+std::size_t
+MemoryBudget::getLimit() const
+{
+    return limit_;
+}
+
+
+std::size_t
+MemoryBudget::getUsedByteCount() const
+{
+    return usedByteCount_;
+}
+
+
+bool
+MemoryBudget::hasRoom(std::size_t size) const
+{
+    return usedByteCount_ + size <= limit_;
+}
+
+} // namespace Gink
@@ -0,0 +1,91 @@
+#pragma once
+
+
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+
+#include "SharedBuffer.h"
+
+
+namespace Gink {
+
+class SegmentedStream final
+{
+    SegmentedStream(const SegmentedStream &) = delete;
+    void operator=(const SegmentedStream &) = delete;
+
+public:
+    inline explicit SegmentedStream(std::size_t = 16384);
+    inline ~SegmentedStream();
+
+    inline std::size_t getSegmentSize() const;
+    inline std::size_t getDataSize() const;
+    inline std::size_t getBufferSize() const;
+
+    int getData(::iovec *, int) const;
+    int getBuffer(::iovec *, int);
+    std::size_t read(void *, std::size_t);
+    void write(const void *, std::size_t);
+    void write(const SharedBuffer &);
+    void growBuffer(std::size_t);
+    void shrinkToFit();
+
+private:
+    struct Segment
+    {
+        std::unique_ptr<char []> base;
+        SharedBuffer sharedBase;
+        std::size_t capacity;
+        std::size_t rIndex;
+        std::size_t wIndex;
+
+        char *getBase() const;
+    };
+
+    const std::size_t segmentSize_;
+    std::deque<Segment> segments_;
+    std::size_t wSegmentIndex_;
+    std::size_t dataSize_;
+};
+
+
+SegmentedStream::SegmentedStream(std::size_t segmentSize)
+    : segmentSize_(segmentSize), wSegmentIndex_(0), dataSize_(0)
+{
+}
+
+
+SegmentedStream::~SegmentedStream()
+{
+}
+
+
+std::size_t
+SegmentedStream::getSegmentSize() const
+{
+    return segmentSize_;
+}
+
+
+std::size_t
+SegmentedStream::getDataSize() const
+{
+    return dataSize_;
+}
+
+
+std::size_t
+SegmentedStream::getBufferSize() const
+{
+    if (wSegmentIndex_ == segments_.size()) {
+        return 0;
+    }
+
+    return (segments_.size() - wSegmentIndex_) * segmentSize_
+           - segments_[wSegmentIndex_].wIndex;
+}
+
+} // namespace Gink
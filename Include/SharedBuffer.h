@@ -0,0 +1,49 @@
+#pragma once
+
+
+#include <cstddef>
+#include <memory>
+
+
+namespace Gink {
+
+class Stream;
+
+
+class SharedBuffer final
+{
+public:
+    inline explicit SharedBuffer();
+
+    explicit SharedBuffer(const void *, std::size_t);
+    explicit SharedBuffer(Stream *);
+
+    inline const void *getData() const;
+    inline std::size_t getSize() const;
+
+private:
+    std::shared_ptr<const char> base_;
+    std::size_t size_;
+};
+
+
+SharedBuffer::SharedBuffer()
+    : size_(0)
+{
+}
+
+
+const void *
+SharedBuffer::getData() const
+{
+    return base_.get();
+}
+
+
+std::size_t
+SharedBuffer::getSize() const
+{
+    return size_;
+}
+
+} // namespace Gink
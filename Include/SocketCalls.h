@@ -0,0 +1,20 @@
+#pragma once
+
+
+#include <netdb.h>
+#include <sys/socket.h>
+
+
+namespace Gink {
+
+void XGetAddrInfo(const char *, const char *, const ::addrinfo *, ::addrinfo **);
+int XSocket(int, int, int);
+void xsetsockopt(int, int, int, const void *, ::socklen_t);
+void xbind(int, const ::sockaddr *, ::socklen_t);
+void xlisten(int, int);
+void XConnect(int, const ::sockaddr *, ::socklen_t, int);
+int XAccept4(int, ::sockaddr *, ::socklen_t *, int, int);
+void xgetsockname(int, ::sockaddr *, ::socklen_t *);
+void xgetpeername(int, ::sockaddr *, ::socklen_t *);
+
+} // namespace Gink
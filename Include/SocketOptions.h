@@ -0,0 +1,33 @@
+#pragma once
+
+
+namespace Gink {
+
+struct SocketOptions
+{
+    inline explicit SocketOptions();
+
+    int sendBufferSize;
+    int receiveBufferSize;
+    int noDelay;
+    int cork;
+    int quickAck;
+    int fastOpen;
+    int busyPollTime;
+    int userTimeout;
+    int keepAlive;
+    int keepAliveIdleTime;
+    int keepAliveInterval;
+    int keepAliveCount;
+    int deferAcceptTime;
+};
+
+
+SocketOptions::SocketOptions()
+    : sendBufferSize(-1), receiveBufferSize(-1), noDelay(-1), cork(-1), quickAck(-1)
+      , fastOpen(-1), busyPollTime(-1), userTimeout(-1), keepAlive(-1), keepAliveIdleTime(-1)
+      , keepAliveInterval(-1), keepAliveCount(-1), deferAcceptTime(-1)
+{
+}
+
+} // namespace Gink
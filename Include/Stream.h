@@ -2,19 +2,21 @@
 
 
 #include <cstddef>
-#include <vector>
 
 
 namespace Gink {
 
+class Allocator;
+
+
 class Stream final
 {
     Stream(const Stream &) = delete;
     void operator=(const Stream &) = delete;
 
 public:
-    inline explicit Stream();
-    inline ~Stream();
+    inline explicit Stream(Allocator * = nullptr);
+    ~Stream();
 
     inline const void *getData() const;
     inline void *getData();
@@ -28,19 +30,20 @@ public:
     void shrinkToFit();
 
 private:
-    std::vector<char> base_;
+    Allocator *const allocator_;
+    char *base_;
+    std::size_t capacity_;
     std::ptrdiff_t rIndex_;
     std::ptrdiff_t wIndex_;
-};
-
 
-Stream::Stream()
-    : rIndex_(0), wIndex_(0)
-{
-}
+    void reallocate(std::size_t);
+    char *allocate(std::size_t);
+    void deallocate(char *, std::size_t) noexcept;
+};
 
 
-Stream::~Stream()
+Stream::Stream(Allocator *allocator)
+    : allocator_(allocator), base_(nullptr), capacity_(0), rIndex_(0), wIndex_(0)
 {
 }
 
@@ -48,14 +51,14 @@ Stream::~Stream()
 const void *
 Stream::getData() const
 {
-    return base_.data() + rIndex_;
+    return base_ + rIndex_;
 }
 
 
 void *
 Stream::getData()
 {
-    return base_.data() + rIndex_;
+    return base_ + rIndex_;
 }
 
 
@@ -69,14 +72,14 @@ Stream::getDataSize() const
 void *
 Stream::getBuffer()
 {
-    return base_.data() + wIndex_;
+    return base_ + wIndex_;
 }
 
 
 std::size_t
 Stream::getBufferSize() const
 {
-    return base_.size() - wIndex_;
+    return capacity_ - wIndex_;
 }
 
 } // namespace Gink
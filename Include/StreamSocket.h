@@ -0,0 +1,65 @@
+#pragma once
+
+
+#include <sys/socket.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+
+namespace Gink {
+
+class SegmentedStream;
+class Stream;
+
+
+// The connected-socket half shared by TCPSocket and UnixSocket: owns the fd and moves Stream
+// and SegmentedStream data through it, adapting the read size to the traffic.
+class StreamSocket final
+{
+    StreamSocket(const StreamSocket &) = delete;
+    void operator=(const StreamSocket &) = delete;
+
+public:
+    inline StreamSocket(StreamSocket &&);
+
+    explicit StreamSocket(int);
+
+    ~StreamSocket();
+
+    inline int getFD() const;
+    std::size_t accept(::sockaddr *, ::socklen_t, std::size_t, int
+                       , const std::function<int (int)> &) const;
+    std::size_t read(Stream *, int) const;
+    std::size_t write(Stream *, int) const;
+    std::size_t write(Stream *const *, std::size_t, int) const;
+    std::size_t read(SegmentedStream *, int) const;
+    std::size_t write(SegmentedStream *, int) const;
+    int tryRead(Stream *, std::size_t *, int) const;
+    int tryWrite(Stream *, std::size_t *, int) const;
+    void shutdownRead() const;
+    void shutdownWrite() const;
+
+private:
+    int fd_;
+    mutable std::atomic<std::size_t> readSize_;
+
+    void updateReadSize(std::size_t, std::size_t, std::size_t) const;
+};
+
+
+StreamSocket::StreamSocket(StreamSocket &&other)
+    : fd_(other.fd_), readSize_(other.readSize_.load(std::memory_order_relaxed))
+{
+    other.fd_ = -1;
+}
+
+
+int
+StreamSocket::getFD() const
+{
+    return fd_;
+}
+
+} // namespace Gink
@@ -23,19 +23,22 @@ public:
     inline ~SystemError() override;
 
     inline int getErrorNumber() const noexcept;
-    inline const char *what() const noexcept override;
+    const char *what() const noexcept override;
 
+    // The location is kept by pointer, so it must be a string literal; the macro above only
+    // accepts literals.
     explicit SystemError(int, const char *);
 
 private:
     int errorNumber_;
-    std::string description_;
+    const char *location_;
+    mutable std::string description_;
 };
 
 
 SystemError::SystemError(SystemError &&other)
     : std::exception(std::move(other)), errorNumber_(other.errorNumber_)
-      , description_(std::move(other.description_))
+      , location_(other.location_), description_(std::move(other.description_))
 {
 }
 
@@ -51,11 +54,4 @@ SystemError::getErrorNumber() const noexcept
     return errorNumber_;
 }
 
-
-const char *
-SystemError::what() const noexcept
-{
-    return description_.c_str();
-}
-
 } // namespace Gink
@@ -3,15 +3,16 @@
 
 #include <climits>
 #include <cstddef>
+#include <utility>
+#include <vector>
 
 #include "IPEndpoint.h"
+#include "SocketOptions.h"
+#include "StreamSocket.h"
 
 
 namespace Gink {
 
-class Stream;
-
-
 class TCPSocket final
 {
     TCPSocket(const TCPSocket &) = delete;
@@ -20,30 +21,107 @@ class TCPSocket final
 public:
     inline TCPSocket(TCPSocket &&);
 
-    static TCPSocket Listen(const char *, const char *, int = INT_MAX);
-    static TCPSocket Connect(const char *, const char *, int = -1);
-
-    ~TCPSocket();
-
-    TCPSocket accept(IPEndpoint * = nullptr, int = -1) const;
-    std::size_t read(Stream *, int = -1) const;
-    std::size_t write(Stream *, int = -1) const;
-    void shutdownRead() const;
-    void shutdownWrite() const;
+    static TCPSocket Listen(const char *, const char *, int = INT_MAX
+                            , const SocketOptions * = nullptr);
+    static std::vector<TCPSocket> ListenSharded(const char *, const char *, int, bool = false
+                                                , int = INT_MAX
+                                                , const SocketOptions * = nullptr);
+    static TCPSocket Connect(const char *, const char *, int = -1
+                             , const SocketOptions * = nullptr);
+    static TCPSocket Connect(const IPEndpoint &, int = -1, const SocketOptions * = nullptr);
+
+    TCPSocket accept(IPEndpoint * = nullptr, int = -1, const SocketOptions * = nullptr) const;
+    std::size_t accept(std::vector<TCPSocket> *, std::size_t, IPEndpoint * = nullptr, int = -1
+                       , const SocketOptions * = nullptr) const;
+    inline std::size_t read(Stream *, int = -1) const;
+    inline std::size_t write(Stream *, int = -1) const;
+    inline std::size_t write(Stream *const *, std::size_t, int = -1) const;
+    inline std::size_t read(SegmentedStream *, int = -1) const;
+    inline std::size_t write(SegmentedStream *, int = -1) const;
+    int tryAccept(std::vector<TCPSocket> *, IPEndpoint * = nullptr, int = -1
+                  , const SocketOptions * = nullptr) const;
+    inline int tryRead(Stream *, std::size_t *, int = -1) const;
+    inline int tryWrite(Stream *, std::size_t *, int = -1) const;
+    inline void shutdownRead() const;
+    inline void shutdownWrite() const;
     IPEndpoint getLocalEndpoint() const;
     IPEndpoint getRemoteEndpoint() const;
+    bool isReusable() const;
+    void setOptions(const SocketOptions &) const;
 
 private:
-    int fd_;
+    StreamSocket socket_;
 
     explicit TCPSocket(int);
 };
 
 
 TCPSocket::TCPSocket(TCPSocket &&other)
-    : fd_(other.fd_)
+    : socket_(std::move(other.socket_))
+{
+}
+
+
+std::size_t
+TCPSocket::read(Stream *stream, int timeout) const
+{
+    return socket_.read(stream, timeout);
+}
+
+
+std::size_t
+TCPSocket::write(Stream *stream, int timeout) const
+{
+    return socket_.write(stream, timeout);
+}
+
+
+std::size_t
+TCPSocket::write(Stream *const *streams, std::size_t numberOfStreams, int timeout) const
+{
+    return socket_.write(streams, numberOfStreams, timeout);
+}
+
+
+std::size_t
+TCPSocket::read(SegmentedStream *stream, int timeout) const
+{
+    return socket_.read(stream, timeout);
+}
+
+
+std::size_t
+TCPSocket::write(SegmentedStream *stream, int timeout) const
+{
+    return socket_.write(stream, timeout);
+}
+
+
+int
+TCPSocket::tryRead(Stream *stream, std::size_t *numberOfBytes, int timeout) const
+{
+    return socket_.tryRead(stream, numberOfBytes, timeout);
+}
+
+
+int
+TCPSocket::tryWrite(Stream *stream, std::size_t *numberOfBytes, int timeout) const
+{
+    return socket_.tryWrite(stream, numberOfBytes, timeout);
+}
+
+
+void
+TCPSocket::shutdownRead() const
+{
+    socket_.shutdownRead();
+}
+
+
+void
+TCPSocket::shutdownWrite() const
 {
-    other.fd_ = -1;
+    socket_.shutdownWrite();
 }
 
 } // namespace Gink
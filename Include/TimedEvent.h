@@ -0,0 +1,40 @@
+#pragma once
+
+
+namespace Gink {
+
+// Like `::Event`, except that a wait can time out. Each waiting fiber blocks reading its own
+// eventfd, so the timeout is the one Pixy already applies to I/O calls.
+class TimedEvent final
+{
+    TimedEvent(const TimedEvent &) = delete;
+    void operator=(const TimedEvent &) = delete;
+
+public:
+    inline explicit TimedEvent();
+
+    inline bool hasWaiters() const;
+
+    void trigger() noexcept;
+    bool waitFor(int);
+
+private:
+    struct Waiter;
+
+    Waiter *firstWaiter_;
+};
+
+
+TimedEvent::TimedEvent()
+    : firstWaiter_(nullptr)
+{
+}
+
+
+bool
+TimedEvent::hasWaiters() const
+{
+    return firstWaiter_ != nullptr;
+}
+
+} // namespace Gink
@@ -0,0 +1,47 @@
+#pragma once
+
+
+#include <cstddef>
+
+#include "IPEndpoint.h"
+
+
+namespace Gink {
+
+class Stream;
+
+
+class UDPSocket final
+{
+    UDPSocket(const UDPSocket &) = delete;
+    void operator=(const UDPSocket &) = delete;
+
+public:
+    inline UDPSocket(UDPSocket &&);
+
+    static UDPSocket Bind(const char *, const char *, bool = false);
+
+    ~UDPSocket();
+
+    std::size_t receive(Stream *const *, IPEndpoint *, std::size_t, std::size_t * = nullptr
+                        , int = -1) const;
+    std::size_t send(Stream *const *, const IPEndpoint *, std::size_t, std::size_t = 0
+                     , int = -1) const;
+    IPEndpoint getLocalEndpoint() const;
+
+private:
+    int fd_;
+    bool usesGRO_;
+    bool supportsGSO_;
+
+    explicit UDPSocket(int, bool, bool);
+};
+
+
+UDPSocket::UDPSocket(UDPSocket &&other)
+    : fd_(other.fd_), usesGRO_(other.usesGRO_), supportsGSO_(other.supportsGSO_)
+{
+    other.fd_ = -1;
+}
+
+} // namespace Gink
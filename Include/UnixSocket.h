@@ -0,0 +1,113 @@
+#pragma once
+
+
+#include <climits>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "StreamSocket.h"
+
+
+namespace Gink {
+
+class UnixSocket final
+{
+    UnixSocket(const UnixSocket &) = delete;
+    void operator=(const UnixSocket &) = delete;
+
+public:
+    inline UnixSocket(UnixSocket &&);
+
+    static UnixSocket Listen(const char *, int = INT_MAX);
+    static UnixSocket Connect(const char *, int = -1);
+
+    UnixSocket accept(int = -1) const;
+    std::size_t accept(std::vector<UnixSocket> *, std::size_t, int = -1) const;
+    inline std::size_t read(Stream *, int = -1) const;
+    inline std::size_t write(Stream *, int = -1) const;
+    inline std::size_t write(Stream *const *, std::size_t, int = -1) const;
+    inline std::size_t read(SegmentedStream *, int = -1) const;
+    inline std::size_t write(SegmentedStream *, int = -1) const;
+    int tryAccept(std::vector<UnixSocket> *, int = -1) const;
+    inline int tryRead(Stream *, std::size_t *, int = -1) const;
+    inline int tryWrite(Stream *, std::size_t *, int = -1) const;
+    inline void shutdownRead() const;
+    inline void shutdownWrite() const;
+
+private:
+    StreamSocket socket_;
+
+    explicit UnixSocket(int);
+};
+
+
+UnixSocket::UnixSocket(UnixSocket &&other)
+    : socket_(std::move(other.socket_))
+{
+}
+
+
+std::size_t
+UnixSocket::read(Stream *stream, int timeout) const
+{
+    return socket_.read(stream, timeout);
+}
+
+
+std::size_t
+UnixSocket::write(Stream *stream, int timeout) const
+{
+    return socket_.write(stream, timeout);
+}
+
+
+std::size_t
+UnixSocket::write(Stream *const *streams, std::size_t numberOfStreams, int timeout) const
+{
+    return socket_.write(streams, numberOfStreams, timeout);
+}
+
+
+std::size_t
+UnixSocket::read(SegmentedStream *stream, int timeout) const
+{
+    return socket_.read(stream, timeout);
+}
+
+
+std::size_t
+UnixSocket::write(SegmentedStream *stream, int timeout) const
+{
+    return socket_.write(stream, timeout);
+}
+
+
+int
+UnixSocket::tryRead(Stream *stream, std::size_t *numberOfBytes, int timeout) const
+{
+    return socket_.tryRead(stream, numberOfBytes, timeout);
+}
+
+
+int
+UnixSocket::tryWrite(Stream *stream, std::size_t *numberOfBytes, int timeout) const
+{
+    return socket_.tryWrite(stream, numberOfBytes, timeout);
+}
+
+
+void
+UnixSocket::shutdownRead() const
+{
+    socket_.shutdownRead();
+}
+
+
+void
+UnixSocket::shutdownWrite() const
+{
+    socket_.shutdownWrite();
+}
+
+} // namespace Gink
@@ -0,0 +1,63 @@
+#include "AddressCache.h"
+
+#include <netdb.h>
+
+#include <cstring>
+
+#include "ScopeGuard.h"
+#include "SocketCalls.h"
+
+
+namespace Gink {
+
+std::string
+AddressCache::MakeKey(const char *hostName, const char *serviceName)
+{
+    std::string key(hostName == nullptr ? "" : hostName);
+    key.push_back('\0');
+    key.append(serviceName == nullptr ? "" : serviceName);
+    return key;
+}
+
+
+IPEndpoint
+AddressCache::resolve(const char *hostName, const char *serviceName)
+{
+    std::string key = MakeKey(hostName, serviceName);
+    auto now = std::chrono::steady_clock::now();
+    auto it = entries_.find(key);
+
+    if (it != entries_.end() && it->second.expiryTime > now) {
+        return it->second.endpoint;
+    }
+
+    ::addrinfo hints;
+    std::memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    ::addrinfo *result;
+    XGetAddrInfo(hostName, serviceName, &hints, &result);
+    ScopeGuard scopeGuard([&result] { ::freeaddrinfo(result); });
+    scopeGuard.appoint();
+    Entry &entry = entries_[key];
+    entry.endpoint.set(*reinterpret_cast<const ::sockaddr_in *>(result->ai_addr));
+    entry.expiryTime = now + timeToLive_;
+    return entry.endpoint;
+}
+
+
+void
+AddressCache::invalidate(const char *hostName, const char *serviceName)
+{
+    entries_.erase(MakeKey(hostName, serviceName));
+}
+
+
+void
+AddressCache::clear()
+{
+    entries_.clear();
+}
+
+} // namespace Gink
@@ -3,12 +3,34 @@
 #include <cerrno>
 #include <cstring>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 #include "Stream.h"
 #include "SystemError.h"
 
 
 namespace Gink {
 
+namespace {
+
+std::uint64_t ToBigEndian(std::uint64_t);
+
+template<class T>
+void CopyBigEndian(void *, const void *, std::size_t);
+
+#if defined(__x86_64__) || defined(__i386__)
+typedef std::size_t (*ShuffleBytesFunction)(char *, const char *, std::size_t, std::size_t);
+
+ShuffleBytesFunction SelectShuffleBytes();
+std::size_t ShuffleBytesSSSE3(char *, const char *, std::size_t, std::size_t);
+std::size_t ShuffleBytesAVX2(char *, const char *, std::size_t, std::size_t);
+#endif
+
+} // namespace
+
+
 #define INTEGER_SERIALIZER(n)                                                                 \
     void                                                                                      \
     Archive::serializeInteger(std::uint##n##_t integer)                                       \
@@ -38,7 +60,9 @@ namespace Gink {
         std::size_t dataSize = stream_->getDataSize() + writtenByteCount_ - readByteCount_;  \
                                                                                              \
         if (dataSize < sizeof *integer) {                                                    \
-            throw GINK_SYSTEM_ERROR(ENODATA, "deserialize failed");                          \
+            handleNoData(sizeof *integer - dataSize);                                        \
+            *integer = 0;                                                                    \
+            return;                                                                          \
         }                                                                                    \
                                                                                              \
         auto data = static_cast<const unsigned char *>(stream_->getData()) + readByteCount_; \
@@ -81,6 +105,207 @@ INTEGER_DESERIALIZER(64)
 #undef INTEGER_DESERIALIZER
 
 
+#define INTEGERS_SERIALIZER(n)                                                                 \
+    void                                                                                       \
+    Archive::serializeIntegers(const std::uint##n##_t *integers, std::size_t numberOfIntegers) \
+    {                                                                                          \
+        std::size_t numberOfBytes = numberOfIntegers * sizeof *integers;                       \
+                                                                                               \
+        std::size_t bufferSize = stream_->getBufferSize() - writtenByteCount_;                 \
+                                                                                               \
+        if (bufferSize < numberOfBytes) {                                                      \
+            stream_->growBuffer(numberOfBytes - bufferSize);                                   \
+        }                                                                                      \
+                                                                                               \
+        auto buffer = static_cast<char *>(stream_->getBuffer()) + writtenByteCount_;           \
+        CopyBigEndian<std::uint##n##_t>(buffer, integers, numberOfIntegers);                   \
+        writtenByteCount_ += numberOfBytes;                                                    \
+    }
+
+#define INTEGERS_DESERIALIZER(n)                                                           \
+    void                                                                                   \
+    Archive::deserializeIntegers(std::uint##n##_t *integers, std::size_t numberOfIntegers) \
+    {                                                                                      \
+        if (!checkDataSize(numberOfIntegers, sizeof *integers)) {                          \
+            return;                                                                        \
+        }                                                                                  \
+                                                                                           \
+        auto data = static_cast<const char *>(stream_->getData()) + readByteCount_;        \
+        CopyBigEndian<std::uint##n##_t>(integers, data, numberOfIntegers);                 \
+        readByteCount_ += numberOfIntegers * sizeof *integers;                             \
+    }
+
+
+INTEGERS_SERIALIZER(8)
+
+
+INTEGERS_DESERIALIZER(8)
+
+
+INTEGERS_SERIALIZER(16)
+
+
+INTEGERS_DESERIALIZER(16)
+
+
+INTEGERS_SERIALIZER(32)
+
+
+INTEGERS_DESERIALIZER(32)
+
+
+INTEGERS_SERIALIZER(64)
+
+
+INTEGERS_DESERIALIZER(64)
+
+
+#undef INTEGERS_SERIALIZER
+#undef INTEGERS_DESERIALIZER
+
+
+unsigned char *
+Archive::getBuffer(std::size_t size)
+{
+    reserve(size);
+    return static_cast<unsigned char *>(stream_->getBuffer()) + writtenByteCount_;
+}
+
+
+const unsigned char *
+Archive::getData() const
+{
+    return static_cast<const unsigned char *>(stream_->getData()) + readByteCount_;
+}
+
+
+std::size_t
+Archive::getReadableSize() const
+{
+    return stream_->getDataSize() + writtenByteCount_ - readByteCount_;
+}
+
+
+void
+Archive::skipBytes(std::size_t numberOfBytes)
+{
+    if (checkDataSize(numberOfBytes, 1)) {
+        readByteCount_ += numberOfBytes;
+    }
+}
+
+
+void
+Archive::skipCompactInteger()
+{
+    if (checkDataSize(1, 1)) {
+        std::uint8_t integerHead = *getData();
+        skipBytes(integerHead == 0 ? 9 : __builtin_clz(integerHead) - 23);
+    }
+}
+
+
+bool
+Archive::checkDataSize(std::size_t numberOfElements, std::size_t elementSize)
+{
+    std::size_t dataSize = getReadableSize();
+
+    if (dataSize / elementSize >= numberOfElements) {
+        return true;
+    }
+
+    if (numberOfElements > std::numeric_limits<std::size_t>::max() / elementSize) {
+        handleNoData(std::numeric_limits<std::size_t>::max());
+    } else {
+        handleNoData(numberOfElements * elementSize - dataSize);
+    }
+
+    return false;
+}
+
+
+void
+Archive::handleNoData(std::size_t missingByteCount)
+{
+    if (!isTrying_) {
+        throw GINK_SYSTEM_ERROR(ENODATA, "deserialize failed");
+    }
+
+    if (missingByteCount_ == 0) {
+        missingByteCount_ = missingByteCount;
+    }
+}
+
+
+void
+Archive::handleBadData()
+{
+    throw GINK_SYSTEM_ERROR(EBADMSG, "deserialize failed");
+}
+
+
+void
+Archive::serializeCompactInteger(std::uint64_t integer)
+{
+    int k = std::numeric_limits<std::uint64_t>::digits - __builtin_clzll(integer | 1);
+    std::size_t n = k > 56 ? 9 : (k + 6) / 7;
+
+    std::size_t bufferSize = stream_->getBufferSize() - writtenByteCount_;
+
+    if (bufferSize < n) {
+        stream_->growBuffer(n - bufferSize);
+    }
+
+    auto buffer = static_cast<unsigned char *>(stream_->getBuffer()) + writtenByteCount_;
+
+    if (n == 9) {
+        buffer[0] = 0;
+        integer = ToBigEndian(integer);
+        std::memcpy(buffer + 1, &integer, sizeof integer);
+    } else {
+        integer = ToBigEndian((integer | UINT64_C(1) << 7 * n) << (64 - 8 * n));
+        std::memcpy(buffer, &integer, n);
+    }
+
+    writtenByteCount_ += n;
+}
+
+
+void
+Archive::deserializeCompactInteger(std::uint64_t *integer)
+{
+    std::size_t dataSize = getReadableSize();
+
+    if (dataSize < 1) {
+        handleNoData(1);
+        *integer = 0;
+        return;
+    }
+
+    auto data = static_cast<const unsigned char *>(stream_->getData()) + readByteCount_;
+    std::size_t n = data[0] == 0 ? 9 : __builtin_clz(data[0]) - 23;
+
+    if (dataSize < n) {
+        handleNoData(n - dataSize);
+        *integer = 0;
+        return;
+    }
+
+    std::uint64_t temp = 0;
+
+    if (n == 9) {
+        std::memcpy(&temp, data + 1, sizeof temp);
+        *integer = ToBigEndian(temp);
+    } else {
+        std::memcpy(&temp, data, dataSize >= sizeof temp ? sizeof temp : n);
+        temp = ToBigEndian(temp) >> (64 - 8 * n);
+        *integer = temp & ((UINT64_C(1) << 7 * n) - 1);
+    }
+
+    readByteCount_ += n;
+}
+
+
 void
 Archive::serializeVariableLengthInteger(std::uintmax_t integer)
 {
@@ -156,6 +381,7 @@ void
 Archive::serializeBytes(const char *bytes, std::size_t numberOfBytes)
 {
     serializeVariableLengthInteger(numberOfBytes);
+
     std::size_t bufferSize = stream_->getBufferSize() - writtenByteCount_;
 
     if (bufferSize < numberOfBytes) {
@@ -174,10 +400,11 @@ Archive::deserializeBytes(const char **bytes, std::size_t *numberOfBytes)
     std::uintmax_t temp;
     deserializeVariableLengthInteger(&temp);
     *numberOfBytes = temp;
-    std::size_t dataSize = stream_->getDataSize() + writtenByteCount_ - readByteCount_;
 
-    if (dataSize < *numberOfBytes) {
-        throw GINK_SYSTEM_ERROR(ENODATA, "deserialize failed");
+    if (!checkDataSize(*numberOfBytes, 1)) {
+        *bytes = nullptr;
+        *numberOfBytes = 0;
+        return;
     }
 
     auto data = static_cast<const char *>(stream_->getData()) + readByteCount_;
@@ -186,6 +413,17 @@ Archive::deserializeBytes(const char **bytes, std::size_t *numberOfBytes)
 }
 
 
+void
+Archive::reserve(std::size_t size)
+{
+    std::size_t bufferSize = stream_->getBufferSize() - writtenByteCount_;
+
+    if (bufferSize < size) {
+        stream_->growBuffer(size - bufferSize);
+    }
+}
+
+
 void
 Archive::flush()
 {
@@ -195,4 +433,150 @@ Archive::flush()
     readByteCount_ = 0;
 }
 
+
+namespace {
+
+inline std::uint8_t
+ByteSwap(std::uint8_t integer)
+{
+    return integer;
+}
+
+
+inline std::uint16_t
+ByteSwap(std::uint16_t integer)
+{
+    return __builtin_bswap16(integer);
+}
+
+
+inline std::uint32_t
+ByteSwap(std::uint32_t integer)
+{
+    return __builtin_bswap32(integer);
+}
+
+
+inline std::uint64_t
+ByteSwap(std::uint64_t integer)
+{
+    return __builtin_bswap64(integer);
+}
+
+
+std::uint64_t
+ToBigEndian(std::uint64_t integer)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return integer;
+#else
+    return ByteSwap(integer);
+#endif
+}
+
+
+template<class T>
+void
+CopyBigEndian(void *target, const void *source, std::size_t numberOfIntegers)
+{
+    if (numberOfIntegers == 0) {
+        return;
+    }
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    std::memcpy(target, source, numberOfIntegers * sizeof(T));
+#else
+    if (sizeof(T) == 1) {
+        std::memcpy(target, source, numberOfIntegers);
+        return;
+    }
+
+    auto t = static_cast<char *>(target);
+    auto s = static_cast<const char *>(source);
+    std::size_t numberOfBytes = numberOfIntegers * sizeof(T);
+    std::size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    static const ShuffleBytesFunction shuffleBytes = SelectShuffleBytes();
+
+    if (shuffleBytes != nullptr) {
+        i = shuffleBytes(t, s, numberOfBytes, sizeof(T));
+    }
+#endif
+
+    for (; i < numberOfBytes; i += sizeof(T)) {
+        T integer;
+        std::memcpy(&integer, s + i, sizeof integer);
+        integer = ByteSwap(integer);
+        std::memcpy(t + i, &integer, sizeof integer);
+    }
+#endif
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+ShuffleBytesFunction
+SelectShuffleBytes()
+{
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        return ShuffleBytesAVX2;
+    }
+
+    if (__builtin_cpu_supports("ssse3")) {
+        return ShuffleBytesSSSE3;
+    }
+
+    return nullptr;
+}
+
+
+__attribute__((target("ssse3"))) std::size_t
+ShuffleBytesSSSE3(char *target, const char *source, std::size_t numberOfBytes
+                  , std::size_t integerSize)
+{
+    alignas(16) char mask[16];
+    std::size_t i;
+
+    for (i = 0; i < 16; ++i) {
+        mask[i] = i - i % integerSize + integerSize - 1 - i % integerSize;
+    }
+
+    __m128i mask128 = _mm_load_si128(reinterpret_cast<const __m128i *>(mask));
+
+    for (i = 0; i + 16 <= numberOfBytes; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(target + i), _mm_shuffle_epi8(x, mask128));
+    }
+
+    return i;
+}
+
+
+__attribute__((target("avx2"))) std::size_t
+ShuffleBytesAVX2(char *target, const char *source, std::size_t numberOfBytes
+                 , std::size_t integerSize)
+{
+    alignas(16) char mask[16];
+    std::size_t i;
+
+    for (i = 0; i < 16; ++i) {
+        mask[i] = i - i % integerSize + integerSize - 1 - i % integerSize;
+    }
+
+    __m256i mask256 = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i *>(mask)));
+
+    for (i = 0; i + 32 <= numberOfBytes; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(target + i)
+                            , _mm256_shuffle_epi8(x, mask256));
+    }
+
+    return i + ShuffleBytesSSSE3(target + i, source + i, numberOfBytes - i, integerSize);
+}
+#endif
+
+} // namespace
+
 } // namespace Gink
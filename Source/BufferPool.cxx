@@ -0,0 +1,275 @@
+#include "BufferPool.h"
+
+#include <new>
+
+
+namespace Gink {
+
+namespace {
+
+const std::size_t ThreadCacheByteCount = std::size_t(1) << 20;
+
+// Trivially destructible, so it stays readable from thread_local destructors that run after the
+// thread cache is gone.
+thread_local bool ThreadCacheIsDestroyed = false;
+
+} // namespace
+
+
+struct BufferPool::Block
+{
+    Block *next;
+};
+
+
+struct BufferPool::FreeList
+{
+    Block *head;
+    std::size_t length;
+};
+
+
+struct BufferPool::ThreadCache
+{
+    FreeList freeLists[NumberOfSizeClasses];
+
+    inline explicit ThreadCache();
+    inline ~ThreadCache();
+};
+
+
+BufferPool::ThreadCache::ThreadCache()
+    : freeLists()
+{
+}
+
+
+BufferPool::ThreadCache::~ThreadCache()
+{
+    BufferPool *pool = BufferPool::GetInstance();
+    ThreadCacheIsDestroyed = true;
+    int i;
+
+    for (i = 0; i < NumberOfSizeClasses; ++i) {
+        while (freeLists[i].head != nullptr) {
+            Block *block = freeLists[i].head;
+            freeLists[i].head = block->next;
+            pool->cachedByteCount_ -= std::size_t(1) << (i + MinSizeClass);
+            pool->deallocateShared(block, i);
+        }
+    }
+}
+
+
+BufferPool *
+BufferPool::GetInstance()
+{
+    static BufferPool *instance = new BufferPool();
+    return instance;
+}
+
+
+BufferPool::BufferPool()
+    : maxCachedByteCount_(std::size_t(64) << 20), sharedCachedByteCount_(0)
+      , sharedFreeLists_(new FreeList[NumberOfSizeClasses]()), numberOfHits_(0)
+      , numberOfMisses_(0), residentByteCount_(0), cachedByteCount_(0)
+{
+}
+
+
+void *
+BufferPool::allocate(std::size_t size)
+{
+    int sizeClass = GetSizeClass(size);
+
+    if (sizeClass < 0) {
+        void *buffer = ::operator new(size);
+        numberOfMisses_.fetch_add(1, std::memory_order_relaxed);
+        residentByteCount_.fetch_add(size, std::memory_order_relaxed);
+        return buffer;
+    }
+
+    ThreadCache *threadCache = GetThreadCache();
+
+    if (threadCache != nullptr && threadCache->freeLists[sizeClass].head != nullptr) {
+        FreeList *freeList = &threadCache->freeLists[sizeClass];
+        Block *block = freeList->head;
+        freeList->head = block->next;
+        --freeList->length;
+        cachedByteCount_.fetch_sub(std::size_t(1) << (sizeClass + MinSizeClass)
+                                   , std::memory_order_relaxed);
+        numberOfHits_.fetch_add(1, std::memory_order_relaxed);
+        return block;
+    }
+
+    return allocateShared(sizeClass);
+}
+
+
+void
+BufferPool::deallocate(void *buffer, std::size_t size) noexcept
+{
+    int sizeClass = GetSizeClass(size);
+
+    if (sizeClass < 0) {
+        ::operator delete(buffer);
+        residentByteCount_.fetch_sub(size, std::memory_order_relaxed);
+        return;
+    }
+
+    ThreadCache *threadCache = GetThreadCache();
+
+    if (threadCache == nullptr) {
+        deallocateShared(buffer, sizeClass);
+        return;
+    }
+
+    std::size_t classSize = std::size_t(1) << (sizeClass + MinSizeClass);
+    FreeList *freeList = &threadCache->freeLists[sizeClass];
+
+    if ((freeList->length + 1) * classSize <= ThreadCacheByteCount) {
+        Block *block = static_cast<Block *>(buffer);
+        block->next = freeList->head;
+        freeList->head = block;
+        ++freeList->length;
+        cachedByteCount_.fetch_add(classSize, std::memory_order_relaxed);
+        return;
+    }
+
+    deallocateShared(buffer, sizeClass);
+}
+
+
+std::size_t
+BufferPool::getBlockSize(std::size_t size) const noexcept
+{
+    int sizeClass = GetSizeClass(size);
+    return sizeClass < 0 ? size : std::size_t(1) << (sizeClass + MinSizeClass);
+}
+
+
+void
+BufferPool::setMaxCachedByteCount(std::size_t maxCachedByteCount)
+{
+    std::lock_guard<std::mutex> lockGuard(mutex_);
+    maxCachedByteCount_ = maxCachedByteCount;
+}
+
+
+void
+BufferPool::trim()
+{
+    std::lock_guard<std::mutex> lockGuard(mutex_);
+    int i;
+
+    for (i = 0; i < NumberOfSizeClasses; ++i) {
+        std::size_t classSize = std::size_t(1) << (i + MinSizeClass);
+
+        while (sharedFreeLists_[i].head != nullptr) {
+            Block *block = sharedFreeLists_[i].head;
+            sharedFreeLists_[i].head = block->next;
+            ::operator delete(block);
+            sharedCachedByteCount_ -= classSize;
+            cachedByteCount_.fetch_sub(classSize, std::memory_order_relaxed);
+            residentByteCount_.fetch_sub(classSize, std::memory_order_relaxed);
+        }
+
+        sharedFreeLists_[i].length = 0;
+    }
+}
+
+
+BufferPool::Statistics
+BufferPool::getStatistics() const
+{
+    Statistics statistics;
+    statistics.numberOfHits = numberOfHits_.load(std::memory_order_relaxed);
+    statistics.numberOfMisses = numberOfMisses_.load(std::memory_order_relaxed);
+    std::size_t numberOfAllocations = statistics.numberOfHits + statistics.numberOfMisses;
+    statistics.hitRate = numberOfAllocations == 0 ? 0.0
+                         : static_cast<double>(statistics.numberOfHits) / numberOfAllocations;
+    statistics.residentByteCount = residentByteCount_.load(std::memory_order_relaxed);
+    statistics.cachedByteCount = cachedByteCount_.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+
+BufferPool::ThreadCache *
+BufferPool::GetThreadCache()
+{
+    if (ThreadCacheIsDestroyed) {
+        return nullptr;
+    }
+
+    static thread_local ThreadCache threadCache;
+    return &threadCache;
+}
+
+
+int
+BufferPool::GetSizeClass(std::size_t size)
+{
+    if (size > std::size_t(1) << MaxSizeClass) {
+        return -1;
+    }
+
+    if (size <= std::size_t(1) << MinSizeClass) {
+        return 0;
+    }
+
+    return (sizeof(unsigned long long) * 8 - __builtin_clzll(size - 1)) - MinSizeClass;
+}
+
+
+void *
+BufferPool::allocateShared(int sizeClass)
+{
+    std::size_t classSize = std::size_t(1) << (sizeClass + MinSizeClass);
+
+    {
+        std::lock_guard<std::mutex> lockGuard(mutex_);
+        FreeList *freeList = &sharedFreeLists_[sizeClass];
+
+        if (freeList->head != nullptr) {
+            Block *block = freeList->head;
+            freeList->head = block->next;
+            --freeList->length;
+            sharedCachedByteCount_ -= classSize;
+            cachedByteCount_.fetch_sub(classSize, std::memory_order_relaxed);
+            numberOfHits_.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+    }
+
+    void *buffer = ::operator new(classSize);
+    numberOfMisses_.fetch_add(1, std::memory_order_relaxed);
+    residentByteCount_.fetch_add(classSize, std::memory_order_relaxed);
+    return buffer;
+}
+
+
+void
+BufferPool::deallocateShared(void *buffer, int sizeClass) noexcept
+{
+    std::size_t classSize = std::size_t(1) << (sizeClass + MinSizeClass);
+
+    {
+        std::lock_guard<std::mutex> lockGuard(mutex_);
+
+        if (sharedCachedByteCount_ + classSize <= maxCachedByteCount_) {
+            FreeList *freeList = &sharedFreeLists_[sizeClass];
+            Block *block = static_cast<Block *>(buffer);
+            block->next = freeList->head;
+            freeList->head = block;
+            ++freeList->length;
+            sharedCachedByteCount_ += classSize;
+            cachedByteCount_.fetch_add(classSize, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    ::operator delete(buffer);
+    residentByteCount_.fetch_sub(classSize, std::memory_order_relaxed);
+}
+
+} // namespace Gink
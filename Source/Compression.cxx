@@ -0,0 +1,356 @@
+#include "Compression.h"
+
+#include <cerrno>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+#include "Stream.h"
+#include "SystemError.h"
+
+
+namespace Gink {
+
+namespace {
+
+enum BlockKind: unsigned char
+{
+    EndBlock = 0,
+    RawBlock = 1,
+    CompressedBlock = 2
+};
+
+const std::size_t BlockSize = 65536;
+const std::size_t BlockHeaderSize = 9;
+const std::size_t MinMatchLength = 4;
+const std::size_t MaxOffset = 65535;
+
+std::size_t GetCompressionBound(std::size_t);
+unsigned char *PrepareBuffer(Stream *, std::size_t);
+void Put32(unsigned char *, std::uint32_t);
+std::uint32_t Get32(const unsigned char *);
+std::uint32_t Load32(const unsigned char *);
+unsigned char *PutLength(unsigned char *, std::size_t);
+
+} // namespace
+
+
+void
+Compressor::compress(Stream *input, Stream *output)
+{
+    assert(input != nullptr && output != nullptr && input != output);
+    auto data = static_cast<const unsigned char *>(input->getData());
+    std::size_t dataSize = input->getDataSize();
+    bool compresses = dataSize >= threshold_;
+    std::size_t i;
+
+    for (i = 0; i < dataSize; i += BlockSize) {
+        std::size_t blockSize = std::min(dataSize - i, BlockSize);
+        unsigned char *buffer = PrepareBuffer(output, BlockHeaderSize
+                                                      + GetCompressionBound(blockSize));
+        std::size_t storedSize = compresses ? compressBlock(data + i, blockSize
+                                                            , buffer + BlockHeaderSize)
+                                            : blockSize;
+
+        if (storedSize >= blockSize) {
+            buffer[0] = RawBlock;
+            std::memcpy(buffer + BlockHeaderSize, data + i, blockSize);
+            storedSize = blockSize;
+        } else {
+            buffer[0] = CompressedBlock;
+        }
+
+        Put32(buffer + 1, storedSize);
+        Put32(buffer + 5, blockSize);
+        output->write(nullptr, BlockHeaderSize + storedSize);
+    }
+
+    unsigned char endBlock = EndBlock;
+    output->write(&endBlock, sizeof endBlock);
+    input->read(nullptr, dataSize);
+}
+
+
+std::size_t
+Compressor::compressBlock(const unsigned char *input, std::size_t inputSize
+                          , unsigned char *output)
+{
+    std::fill(std::begin(hashTable_), std::end(hashTable_), 0);
+    const unsigned char *inputEnd = input + inputSize;
+    const unsigned char *anchor = input;
+    const unsigned char *p = input;
+    unsigned char *q = output;
+
+    while (p + MinMatchLength <= inputEnd) {
+        std::uint32_t sequence = Load32(p);
+        std::uint32_t hash = sequence * UINT32_C(2654435761) >> 20;
+        const unsigned char *match = input + hashTable_[hash];
+        hashTable_[hash] = p - input;
+
+        if (match >= p || p - match > static_cast<std::ptrdiff_t>(MaxOffset)
+            || Load32(match) != sequence) {
+            std::size_t step = 1 + ((p - anchor) >> 6);
+
+            if (static_cast<std::size_t>(inputEnd - p) < MinMatchLength + step) {
+                break;
+            }
+
+            p += step;
+            continue;
+        }
+
+        while (p > anchor && match > input && p[-1] == match[-1]) {
+            --p;
+            --match;
+        }
+
+        const unsigned char *matchEnd = p + MinMatchLength;
+        const unsigned char *matchEnd2 = match + MinMatchLength;
+
+        while (matchEnd < inputEnd && *matchEnd == *matchEnd2) {
+            ++matchEnd;
+            ++matchEnd2;
+        }
+
+        std::size_t literalLength = p - anchor;
+        std::size_t matchLength = matchEnd - p - MinMatchLength;
+        unsigned char *token = q++;
+        *token = std::min<std::size_t>(literalLength, 15) << 4
+                 | std::min<std::size_t>(matchLength, 15);
+
+        if (literalLength >= 15) {
+            q = PutLength(q, literalLength - 15);
+        }
+
+        std::memcpy(q, anchor, literalLength);
+        q += literalLength;
+        std::size_t offset = p - match;
+        q[0] = offset;
+        q[1] = offset >> 8;
+        q += 2;
+
+        if (matchLength >= 15) {
+            q = PutLength(q, matchLength - 15);
+        }
+
+        p = matchEnd;
+        anchor = p;
+    }
+
+    std::size_t literalLength = inputEnd - anchor;
+    *q++ = std::min<std::size_t>(literalLength, 15) << 4;
+
+    if (literalLength >= 15) {
+        q = PutLength(q, literalLength - 15);
+    }
+
+    std::memcpy(q, anchor, literalLength);
+    q += literalLength;
+    return q - output;
+}
+
+
+bool
+Decompressor::decompress(Stream *input, Stream *output)
+{
+    assert(input != nullptr && output != nullptr && input != output);
+
+    for (;;) {
+        auto data = static_cast<const unsigned char *>(input->getData());
+        std::size_t dataSize = input->getDataSize();
+
+        if (dataSize < 1) {
+            return false;
+        }
+
+        if (data[0] == EndBlock) {
+            input->read(nullptr, 1);
+            return true;
+        }
+
+        if (dataSize < BlockHeaderSize) {
+            return false;
+        }
+
+        std::size_t storedSize = Get32(data + 1);
+        std::size_t blockSize = Get32(data + 5);
+
+        if ((data[0] != RawBlock && data[0] != CompressedBlock) || blockSize > BlockSize
+            || storedSize > GetCompressionBound(blockSize)
+            || (data[0] == RawBlock && storedSize != blockSize)) {
+            throw GINK_SYSTEM_ERROR(EBADMSG, "decompress failed");
+        }
+
+        if (dataSize < BlockHeaderSize + storedSize) {
+            return false;
+        }
+
+        unsigned char *buffer = PrepareBuffer(output, blockSize);
+
+        if (data[0] == RawBlock) {
+            std::memcpy(buffer, data + BlockHeaderSize, blockSize);
+        } else {
+            decompressBlock(data + BlockHeaderSize, storedSize, buffer, blockSize);
+        }
+
+        output->write(nullptr, blockSize);
+        input->read(nullptr, BlockHeaderSize + storedSize);
+    }
+}
+
+
+void
+Decompressor::decompressBlock(const unsigned char *input, std::size_t inputSize
+                              , unsigned char *output, std::size_t outputSize)
+{
+    const unsigned char *p = input;
+    const unsigned char *inputEnd = input + inputSize;
+    unsigned char *q = output;
+    unsigned char *outputEnd = output + outputSize;
+
+    for (;;) {
+        if (p >= inputEnd) {
+            throw GINK_SYSTEM_ERROR(EBADMSG, "decompress failed");
+        }
+
+        unsigned token = *p++;
+        std::size_t literalLength = token >> 4;
+
+        if (literalLength == 15) {
+            unsigned char x;
+
+            do {
+                if (p >= inputEnd) {
+                    throw GINK_SYSTEM_ERROR(EBADMSG, "decompress failed");
+                }
+
+                x = *p++;
+                literalLength += x;
+            } while (x == 255);
+        }
+
+        if (literalLength > static_cast<std::size_t>(inputEnd - p)
+            || literalLength > static_cast<std::size_t>(outputEnd - q)) {
+            throw GINK_SYSTEM_ERROR(EBADMSG, "decompress failed");
+        }
+
+        std::memcpy(q, p, literalLength);
+        p += literalLength;
+        q += literalLength;
+
+        if (p == inputEnd) {
+            break;
+        }
+
+        if (inputEnd - p < 2) {
+            throw GINK_SYSTEM_ERROR(EBADMSG, "decompress failed");
+        }
+
+        std::size_t offset = p[0] | p[1] << 8;
+        p += 2;
+        std::size_t matchLength = token & 15;
+
+        if (matchLength == 15) {
+            unsigned char x;
+
+            do {
+                if (p >= inputEnd) {
+                    throw GINK_SYSTEM_ERROR(EBADMSG, "decompress failed");
+                }
+
+                x = *p++;
+                matchLength += x;
+            } while (x == 255);
+        }
+
+        matchLength += MinMatchLength;
+
+        if (offset == 0 || offset > static_cast<std::size_t>(q - output)
+            || matchLength > static_cast<std::size_t>(outputEnd - q)) {
+            throw GINK_SYSTEM_ERROR(EBADMSG, "decompress failed");
+        }
+
+        const unsigned char *match = q - offset;
+
+        if (offset >= matchLength) {
+            std::memcpy(q, match, matchLength);
+            q += matchLength;
+        } else {
+            unsigned char *qEnd = q + matchLength;
+
+            while (q < qEnd) {
+                *q++ = *match++;
+            }
+        }
+    }
+
+    if (q != outputEnd) {
+        throw GINK_SYSTEM_ERROR(EBADMSG, "decompress failed");
+    }
+}
+
+
+namespace {
+
+std::size_t
+GetCompressionBound(std::size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+
+unsigned char *
+PrepareBuffer(Stream *stream, std::size_t size)
+{
+    std::size_t bufferSize = stream->getBufferSize();
+
+    if (bufferSize < size) {
+        stream->growBuffer(size - bufferSize);
+    }
+
+    return static_cast<unsigned char *>(stream->getBuffer());
+}
+
+
+void
+Put32(unsigned char *buffer, std::uint32_t integer)
+{
+    buffer[0] = integer >> 24;
+    buffer[1] = integer >> 16;
+    buffer[2] = integer >> 8;
+    buffer[3] = integer;
+}
+
+
+std::uint32_t
+Get32(const unsigned char *data)
+{
+    return std::uint32_t(data[0]) << 24 | std::uint32_t(data[1]) << 16
+           | std::uint32_t(data[2]) << 8 | data[3];
+}
+
+
+std::uint32_t
+Load32(const unsigned char *data)
+{
+    std::uint32_t integer;
+    std::memcpy(&integer, data, sizeof integer);
+    return integer;
+}
+
+
+unsigned char *
+PutLength(unsigned char *buffer, std::size_t length)
+{
+    while (length >= 255) {
+        *buffer++ = 255;
+        length -= 255;
+    }
+
+    *buffer++ = length;
+    return buffer;
+}
+
+} // namespace
+
+} // namespace Gink
@@ -0,0 +1,113 @@
+#include "ConnectionPool.h"
+
+#include <cassert>
+#include <cerrno>
+#include <utility>
+
+#include "Deadline.h"
+#include "ScopeGuard.h"
+#include "SystemError.h"
+
+
+namespace Gink {
+
+ConnectionPool::Endpoint::Endpoint()
+    : numberOfConnections(0)
+{
+}
+
+
+ConnectionPool::Lease
+ConnectionPool::acquire(const char *hostName, const char *serviceName, int timeout)
+{
+    Deadline deadline(timeout);
+    Endpoint *endpoint = &endpoints_[AddressCache::MakeKey(hostName, serviceName)];
+    removeIdleConnections(endpoint, std::chrono::steady_clock::now());
+
+    for (;;) {
+        while (!endpoint->idleConnections.empty()) {
+            TCPSocket socket(std::move(endpoint->idleConnections.back().socket));
+            endpoint->idleConnections.pop_back();
+
+            if (socket.isReusable()) {
+                return Lease(this, endpoint, std::move(socket));
+            }
+
+            --endpoint->numberOfConnections;
+        }
+
+        if (endpoint->numberOfConnections < maxNumberOfConnections_) {
+            break;
+        }
+
+        if (!endpoint->event.waitFor(deadline.getRemainingTime())) {
+            throw GINK_SYSTEM_ERROR(ETIMEDOUT, "connection pool exhausted");
+        }
+    }
+
+    ++endpoint->numberOfConnections;
+    ScopeGuard scopeGuard1([endpoint] { --endpoint->numberOfConnections; });
+    scopeGuard1.appoint();
+    IPEndpoint address = addressCache_.resolve(hostName, serviceName);
+    ScopeGuard scopeGuard2([&] { addressCache_.invalidate(hostName, serviceName); });
+    scopeGuard2.appoint();
+    TCPSocket socket = TCPSocket::Connect(address, deadline.getRemainingTime());
+    scopeGuard2.dismiss();
+    scopeGuard1.dismiss();
+    return Lease(this, endpoint, std::move(socket));
+}
+
+
+void
+ConnectionPool::release(Endpoint *endpoint, TCPSocket &&socket, bool isReusable)
+{
+    assert(endpoint->numberOfConnections >= 1);
+
+    if (isReusable) {
+        endpoint->idleConnections.push_back({std::move(socket), std::chrono::steady_clock::now()});
+    } else {
+        TCPSocket closedSocket(std::move(socket));
+        --endpoint->numberOfConnections;
+    }
+
+    endpoint->event.trigger();
+}
+
+
+void
+ConnectionPool::removeIdleConnections()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    for (auto &keyAndEndpoint: endpoints_) {
+        removeIdleConnections(&keyAndEndpoint.second, now);
+    }
+}
+
+
+void
+ConnectionPool::removeIdleConnections(Endpoint *endpoint
+                                      , std::chrono::steady_clock::time_point now)
+{
+    std::size_t numberOfIdleConnections = endpoint->idleConnections.size();
+
+    while (!endpoint->idleConnections.empty()
+           && now - endpoint->idleConnections.front().releaseTime >= maxIdleTime_) {
+        endpoint->idleConnections.pop_front();
+        --endpoint->numberOfConnections;
+    }
+
+    if (endpoint->idleConnections.size() < numberOfIdleConnections) {
+        endpoint->event.trigger();
+    }
+}
+
+
+ConnectionPool::Lease::~Lease()
+{
+    if (pool_ != nullptr) {
+        pool_->release(endpoint_, std::move(socket_), isReusable_);
+    }
+}
+
+} // namespace Gink
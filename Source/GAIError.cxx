@@ -5,14 +5,33 @@
 
 namespace Gink {
 
-GAIError::GAIError(int errorCode, const char *description)
-    : errorCode_(errorCode), description_(description)
+GAIError::GAIError(int errorCode, const char *location)
+    : errorCode_(errorCode), location_(location)
 {
-    if (errorCode_ != 0) {
-        description_.push_back(':');
-        description_.push_back(' ');
-        description_ += ::gai_strerror(errorCode_);
+}
+
+
+const char *
+GAIError::what() const noexcept
+{
+    if (!description_.empty()) {
+        return description_.c_str();
     }
+
+    try {
+        description_ = location_;
+
+        if (errorCode_ != 0) {
+            description_.push_back(':');
+            description_.push_back(' ');
+            description_ += ::gai_strerror(errorCode_);
+        }
+    } catch (...) {
+        description_.clear();
+        return location_;
+    }
+
+    return description_.c_str();
 }
 
 } // namespace Gink
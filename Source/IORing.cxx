@@ -0,0 +1,660 @@
+#include "IORing.h"
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+#include <Pixy/Event.h>
+#include <Pixy/IO.h>
+#include <Pixy/Runtime.h>
+
+#include "Coroutine.h"
+#include "ScopeGuard.h"
+#include "SystemError.h"
+
+
+namespace Gink {
+
+namespace {
+
+bool ProbeOpcodes(int);
+int IOURingSetup(unsigned, ::io_uring_params *);
+int IOURingEnter(int, unsigned, unsigned, unsigned);
+int IOURingRegister(int, unsigned, const void *, unsigned);
+void XIOURingRegister(int, unsigned, const void *, unsigned);
+void *XMMap(std::size_t, int, ::off_t);
+int XEventFD(unsigned, int);
+::ssize_t SetErrorNumber(int);
+unsigned ClampLength(std::size_t);
+
+const ::__u64 CurrentOffset = ~::__u64(0);
+
+} // namespace
+
+
+struct IORing::Request
+{
+    ::Event event;
+    int result;
+    bool isCompleted;
+    ::__kernel_timespec timeout;
+};
+
+
+IORing *
+IORing::GetInstance()
+{
+    static thread_local bool isCreated = false;
+    static thread_local std::unique_ptr<IORing> instance;
+
+    if (!isCreated) {
+        isCreated = true;
+        instance = Create();
+    }
+
+    return instance.get();
+}
+
+
+::ssize_t
+IORing::Read(int fd, void *buffer, std::size_t bufferSize, int timeout)
+{
+    IORing *instance = timeout == 0 ? nullptr : GetInstance();
+
+    if (instance != nullptr) {
+        ::io_uring_sqe sqe;
+        std::memset(&sqe, 0, sizeof sqe);
+        int bufferIndex = instance->findRegisteredBuffer(buffer, bufferSize);
+
+        // No socket opcode takes a registered buffer. Older kernels complete READ_FIXED and
+        // WRITE_FIXED on an O_NONBLOCK socket with -EAGAIN, which falls back to Pixy below.
+        if (bufferIndex < 0) {
+            sqe.opcode = IORING_OP_RECV;
+        } else {
+            sqe.opcode = IORING_OP_READ_FIXED;
+            sqe.off = CurrentOffset;
+            sqe.buf_index = bufferIndex;
+        }
+
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(buffer);
+        sqe.len = ClampLength(bufferSize);
+        int result = instance->execute(sqe, timeout);
+
+        if (result != -EAGAIN) {
+            return SetErrorNumber(result);
+        }
+    }
+
+    return ::Read(fd, buffer, bufferSize, timeout);
+}
+
+
+::ssize_t
+IORing::ReadV(int fd, const ::iovec *vector, int vectorLength, int timeout)
+{
+    IORing *instance = timeout == 0 ? nullptr : GetInstance();
+
+    if (instance != nullptr) {
+        ::io_uring_sqe sqe;
+        std::memset(&sqe, 0, sizeof sqe);
+        ::msghdr message;
+        std::memset(&message, 0, sizeof message);
+        message.msg_iov = const_cast<::iovec *>(vector);
+        message.msg_iovlen = vectorLength;
+        sqe.opcode = IORING_OP_RECVMSG;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(&message);
+        sqe.len = 1;
+        int result = instance->execute(sqe, timeout);
+
+        if (result != -EAGAIN) {
+            return SetErrorNumber(result);
+        }
+    }
+
+    return ::ReadV(fd, vector, vectorLength, timeout);
+}
+
+
+::ssize_t
+IORing::Write(int fd, const void *data, std::size_t dataSize, int timeout)
+{
+    IORing *instance = timeout == 0 ? nullptr : GetInstance();
+
+    if (instance != nullptr) {
+        ::io_uring_sqe sqe;
+        std::memset(&sqe, 0, sizeof sqe);
+        int bufferIndex = instance->findRegisteredBuffer(data, dataSize);
+
+        if (bufferIndex < 0) {
+            sqe.opcode = IORING_OP_SEND;
+        } else {
+            sqe.opcode = IORING_OP_WRITE_FIXED;
+            sqe.off = CurrentOffset;
+            sqe.buf_index = bufferIndex;
+        }
+
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(data);
+        sqe.len = ClampLength(dataSize);
+        int result = instance->execute(sqe, timeout);
+
+        if (result != -EAGAIN) {
+            return SetErrorNumber(result);
+        }
+    }
+
+    return ::Write(fd, data, dataSize, timeout);
+}
+
+
+::ssize_t
+IORing::WriteV(int fd, const ::iovec *vector, int vectorLength, int timeout)
+{
+    IORing *instance = timeout == 0 ? nullptr : GetInstance();
+
+    if (instance != nullptr) {
+        ::io_uring_sqe sqe;
+        std::memset(&sqe, 0, sizeof sqe);
+        ::msghdr message;
+        std::memset(&message, 0, sizeof message);
+        message.msg_iov = const_cast<::iovec *>(vector);
+        message.msg_iovlen = vectorLength;
+        sqe.opcode = IORING_OP_SENDMSG;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(&message);
+        sqe.len = 1;
+        int result = instance->execute(sqe, timeout);
+
+        if (result != -EAGAIN) {
+            return SetErrorNumber(result);
+        }
+    }
+
+    return ::WriteV(fd, vector, vectorLength, timeout);
+}
+
+
+int
+IORing::Accept4(int fd, ::sockaddr *name, ::socklen_t *nameSize, int flags, int timeout)
+{
+    IORing *instance = timeout == 0 ? nullptr : GetInstance();
+
+    if (instance != nullptr) {
+        ::io_uring_sqe sqe;
+        std::memset(&sqe, 0, sizeof sqe);
+        sqe.opcode = IORING_OP_ACCEPT;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uintptr_t>(name);
+        sqe.addr2 = reinterpret_cast<std::uintptr_t>(nameSize);
+        sqe.accept_flags = flags | SOCK_NONBLOCK | SOCK_CLOEXEC;
+        int result = instance->execute(sqe, timeout);
+
+        if (result != -EAGAIN) {
+            return SetErrorNumber(result);
+        }
+    }
+
+    return ::Accept4(fd, name, nameSize, flags, timeout);
+}
+
+
+std::unique_ptr<IORing>
+IORing::Create()
+{
+    ::io_uring_params params;
+    std::memset(&params, 0, sizeof params);
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = 4 * NumberOfEntries;
+    int fd = IOURingSetup(NumberOfEntries, &params);
+
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    if ((params.features & IORING_FEAT_NODROP) == 0 || !ProbeOpcodes(fd)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    try {
+        std::unique_ptr<IORing> instance(new IORing(fd, params));
+        IORing *ring = instance.get();
+        // A new fiber does not run until its creator yields, so the reaper can still be told to
+        // exit if the flusher fails to start.
+        auto isAborted = std::make_shared<bool>(false);
+
+        CoAdd([ring, isAborted] () -> void {
+            if (!*isAborted) {
+                ring->runReaper();
+            }
+        });
+
+        ScopeGuard scopeGuard1([&isAborted] { *isAborted = true; });
+        scopeGuard1.appoint();
+        CoAdd([ring] () -> void { ring->runFlusher(); });
+        scopeGuard1.dismiss();
+        return instance;
+    } catch (const SystemError &) {
+        return nullptr;
+    }
+}
+
+
+IORing::IORing(int fd, const ::io_uring_params &params)
+    : fd_(fd), numberOfPendingSQEs_(0)
+{
+    ::Event_Initialize(&flushEvent_);
+    ScopeGuard scopeGuard1([this] { ::close(fd_); });
+    scopeGuard1.appoint();
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    }
+
+    sqRing_ = XMMap(sqRingSize_, fd_, IORING_OFF_SQ_RING);
+    ScopeGuard scopeGuard2([this] { ::munmap(sqRing_, sqRingSize_); });
+    scopeGuard2.appoint();
+
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        cqRing_ = sqRing_;
+    } else {
+        cqRing_ = XMMap(cqRingSize_, fd_, IORING_OFF_CQ_RING);
+    }
+
+    ScopeGuard scopeGuard3([this] {
+        if (cqRing_ != sqRing_) {
+            ::munmap(cqRing_, cqRingSize_);
+        }
+    });
+
+    scopeGuard3.appoint();
+    sqesSize_ = params.sq_entries * sizeof(::io_uring_sqe);
+    sqes_ = static_cast<::io_uring_sqe *>(XMMap(sqesSize_, fd_, IORING_OFF_SQES));
+    ScopeGuard scopeGuard4([this] { ::munmap(sqes_, sqesSize_); });
+    scopeGuard4.appoint();
+    eventFD_ = XEventFD(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ScopeGuard scopeGuard5([this] { ::close(eventFD_); });
+    scopeGuard5.appoint();
+    XIOURingRegister(fd_, IORING_REGISTER_EVENTFD, &eventFD_, 1);
+    char *sqRing = static_cast<char *>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned *>(sqRing + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned *>(sqRing + params.sq_off.tail);
+    sqFlags_ = reinterpret_cast<unsigned *>(sqRing + params.sq_off.flags);
+    sqArray_ = reinterpret_cast<unsigned *>(sqRing + params.sq_off.array);
+    sqMask_ = *reinterpret_cast<unsigned *>(sqRing + params.sq_off.ring_mask);
+    sqEntries_ = params.sq_entries;
+    sqLocalTail_ = *sqTail_;
+    char *cqRing = static_cast<char *>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned *>(cqRing + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned *>(cqRing + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned *>(cqRing + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<::io_uring_cqe *>(cqRing + params.cq_off.cqes);
+    scopeGuard1.dismiss();
+    scopeGuard2.dismiss();
+    scopeGuard3.dismiss();
+    scopeGuard4.dismiss();
+    scopeGuard5.dismiss();
+}
+
+
+IORing::~IORing()
+{
+    ::close(eventFD_);
+    ::munmap(sqes_, sqesSize_);
+
+    if (cqRing_ != sqRing_) {
+        ::munmap(cqRing_, cqRingSize_);
+    }
+
+    ::munmap(sqRing_, sqRingSize_);
+    ::close(fd_);
+}
+
+
+void
+IORing::registerBuffers(const ::iovec *vector, int vectorLength)
+{
+    unregisterBuffers();
+    XIOURingRegister(fd_, IORING_REGISTER_BUFFERS, vector, vectorLength);
+    registeredBuffers_.assign(vector, vector + vectorLength);
+}
+
+
+void
+IORing::unregisterBuffers()
+{
+    if (registeredBuffers_.empty()) {
+        return;
+    }
+
+    registeredBuffers_.clear();
+    XIOURingRegister(fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+}
+
+
+int
+IORing::execute(const ::io_uring_sqe &sqe, int timeout)
+{
+    unsigned numberOfSQEs = timeout < 0 ? 1 : 2;
+    int result = reserveSQEs(numberOfSQEs);
+
+    if (result < 0) {
+        return result;
+    }
+
+    Request request;
+    ::Event_Initialize(&request.event);
+    request.isCompleted = false;
+    ::io_uring_sqe *operationSQE = pushSQE();
+    *operationSQE = sqe;
+    operationSQE->user_data = reinterpret_cast<std::uintptr_t>(&request);
+
+    if (timeout >= 0) {
+        request.timeout.tv_sec = timeout / 1000;
+        request.timeout.tv_nsec = timeout % 1000 * 1000000;
+        operationSQE->flags |= IOSQE_IO_LINK;
+        ::io_uring_sqe *timeoutSQE = pushSQE();
+        std::memset(timeoutSQE, 0, sizeof *timeoutSQE);
+        timeoutSQE->opcode = IORING_OP_LINK_TIMEOUT;
+        timeoutSQE->fd = -1;
+        timeoutSQE->addr = reinterpret_cast<std::uintptr_t>(&request.timeout);
+        timeoutSQE->len = 1;
+    }
+
+    __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+
+    if (numberOfPendingSQEs_ == 0) {
+        ::Event_Trigger(&flushEvent_);
+    }
+
+    numberOfPendingSQEs_ += numberOfSQEs;
+
+    while (!request.isCompleted) {
+        ::Event_WaitFor(&request.event);
+    }
+
+    if (timeout >= 0 && request.result == -ECANCELED) {
+        return -ETIMEDOUT;
+    }
+
+    return request.result;
+}
+
+
+::io_uring_sqe *
+IORing::pushSQE()
+{
+    unsigned index = sqLocalTail_++ & sqMask_;
+    sqArray_[index] = index;
+    return &sqes_[index];
+}
+
+
+int
+IORing::reserveSQEs(unsigned numberOfSQEs)
+{
+    while (sqLocalTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) + numberOfSQEs
+           > sqEntries_) {
+        int result = flush();
+
+        if (result < 0) {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+
+int
+IORing::flush()
+{
+    while (numberOfPendingSQEs_ >= 1) {
+        int numberOfSQEs = IOURingEnter(fd_, numberOfPendingSQEs_, 0, 0);
+
+        if (numberOfSQEs < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                int result = -errno;
+                discardSQEs(result);
+                return result;
+            }
+
+            reap();
+            ::YieldCurrentFiber();
+        } else {
+            numberOfPendingSQEs_ -= numberOfSQEs;
+        }
+    }
+
+    reap();
+    return 0;
+}
+
+
+void
+IORing::discardSQEs(int result)
+{
+    unsigned sqHead = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+
+    while (sqLocalTail_ != sqHead) {
+        const ::io_uring_sqe &sqe = sqes_[sqArray_[--sqLocalTail_ & sqMask_]];
+
+        if (sqe.user_data != 0) {
+            completeRequest(reinterpret_cast<Request *>(sqe.user_data), result);
+        }
+    }
+
+    __atomic_store_n(sqTail_, sqLocalTail_, __ATOMIC_RELEASE);
+    numberOfPendingSQEs_ = 0;
+}
+
+
+void
+IORing::reap()
+{
+    for (;;) {
+        unsigned cqHead = *cqHead_;
+        unsigned cqTail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+
+        for (; cqHead != cqTail; ++cqHead) {
+            const ::io_uring_cqe &cqe = cqes_[cqHead & cqMask_];
+
+            if (cqe.user_data != 0) {
+                completeRequest(reinterpret_cast<Request *>(cqe.user_data), cqe.res);
+            }
+        }
+
+        __atomic_store_n(cqHead_, cqHead, __ATOMIC_RELEASE);
+
+        if ((__atomic_load_n(sqFlags_, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) == 0) {
+            return;
+        }
+
+        IOURingEnter(fd_, 0, 0, IORING_ENTER_GETEVENTS);
+    }
+}
+
+
+void
+IORing::completeRequest(Request *request, int result)
+{
+    request->result = result;
+    request->isCompleted = true;
+    ::Event_Trigger(&request->event);
+}
+
+
+void
+IORing::runReaper()
+{
+    for (;;) {
+        std::uint64_t counter;
+
+        if (::Read(eventFD_, &counter, sizeof counter, -1) < 0 && errno != EINTR) {
+            ::YieldCurrentFiber();
+        }
+
+        reap();
+    }
+}
+
+
+// Pixy has no idle hook. Fibers queue their entries and wait; the flusher yields until a whole
+// round of the scheduler queues nothing more, then submits the batch with one syscall.
+void
+IORing::runFlusher()
+{
+    for (;;) {
+        while (numberOfPendingSQEs_ == 0) {
+            ::Event_WaitFor(&flushEvent_);
+        }
+
+        unsigned numberOfPendingSQEs;
+
+        do {
+            numberOfPendingSQEs = numberOfPendingSQEs_;
+            ::YieldCurrentFiber();
+        } while (numberOfPendingSQEs_ != numberOfPendingSQEs);
+
+        flush();
+    }
+}
+
+
+int
+IORing::findRegisteredBuffer(const void *buffer, std::size_t bufferSize) const
+{
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(buffer);
+
+    for (std::size_t i = 0; i < registeredBuffers_.size(); ++i) {
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(registeredBuffers_[i].iov_base);
+
+        if (address >= base && address + bufferSize <= base + registeredBuffers_[i].iov_len) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+namespace {
+
+bool
+ProbeOpcodes(int fd)
+{
+    const int opcodes[] = {
+        IORING_OP_RECV, IORING_OP_READ_FIXED, IORING_OP_RECVMSG,
+        IORING_OP_SEND, IORING_OP_WRITE_FIXED, IORING_OP_SENDMSG,
+        IORING_OP_ACCEPT, IORING_OP_LINK_TIMEOUT
+    };
+
+    std::size_t probeSize = sizeof(::io_uring_probe) + IORING_OP_LAST
+                            * sizeof(::io_uring_probe_op);
+    std::unique_ptr<char[]> buffer(new char[probeSize]());
+    ::io_uring_probe *probe = reinterpret_cast<::io_uring_probe *>(buffer.get());
+
+    if (IOURingRegister(fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) < 0) {
+        return false;
+    }
+
+    for (int opcode: opcodes) {
+        if (opcode > probe->last_op
+            || (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int
+IOURingSetup(unsigned numberOfEntries, ::io_uring_params *params)
+{
+    return ::syscall(__NR_io_uring_setup, numberOfEntries, params);
+}
+
+
+int
+IOURingEnter(int fd, unsigned numberOfSQEs, unsigned minNumberOfCQEs, unsigned flags)
+{
+    return ::syscall(__NR_io_uring_enter, fd, numberOfSQEs, minNumberOfCQEs, flags, nullptr, 0);
+}
+
+
+int
+IOURingRegister(int fd, unsigned opcode, const void *argument, unsigned numberOfArguments)
+{
+    return ::syscall(__NR_io_uring_register, fd, opcode, argument, numberOfArguments);
+}
+
+
+void
+XIOURingRegister(int fd, unsigned opcode, const void *argument, unsigned numberOfArguments)
+{
+    if (IOURingRegister(fd, opcode, argument, numberOfArguments) < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::io_uring_register()` failed");
+    }
+}
+
+
+void *
+XMMap(std::size_t length, int fd, ::off_t offset)
+{
+    void *address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE
+                           , fd, offset);
+
+    if (address == MAP_FAILED) {
+        throw GINK_SYSTEM_ERROR(errno, "`::mmap()` failed");
+    }
+
+    return address;
+}
+
+
+int
+XEventFD(unsigned initialValue, int flags)
+{
+    int fd = ::eventfd(initialValue, flags);
+
+    if (fd < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::eventfd()` failed");
+    }
+
+    return fd;
+}
+
+
+::ssize_t
+SetErrorNumber(int result)
+{
+    if (result < 0) {
+        errno = -result;
+        return -1;
+    }
+
+    return result;
+}
+
+
+unsigned
+ClampLength(std::size_t length)
+{
+    return std::min(length, std::size_t(UINT_MAX));
+}
+
+} // namespace
+
+} // namespace Gink
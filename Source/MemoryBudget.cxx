@@ -0,0 +1,76 @@
+#include "MemoryBudget.h"
+
+#include <cerrno>
+#include <new>
+
+#include "Deadline.h"
+#include "SystemError.h"
+
+
+namespace Gink {
+
+MemoryBudget::MemoryBudget(std::size_t limit, Allocator *upstream, bool allowsOvercommit)
+    : upstream_(upstream), allowsOvercommit_(allowsOvercommit), limit_(limit), usedByteCount_(0)
+{
+}
+
+
+void *
+MemoryBudget::allocate(std::size_t size)
+{
+    std::size_t blockSize = getBlockSize(size);
+
+    if (!allowsOvercommit_ && !hasRoom(blockSize)) {
+        throw GINK_SYSTEM_ERROR(ENOBUFS, "memory budget exceeded");
+    }
+
+    void *buffer = upstream_ == nullptr ? ::operator new(size) : upstream_->allocate(size);
+    usedByteCount_ += blockSize;
+    return buffer;
+}
+
+
+void
+MemoryBudget::deallocate(void *buffer, std::size_t size) noexcept
+{
+    std::size_t blockSize = getBlockSize(size);
+
+    if (upstream_ == nullptr) {
+        ::operator delete(buffer);
+    } else {
+        upstream_->deallocate(buffer, size);
+    }
+
+    usedByteCount_ -= blockSize;
+    event_.trigger();
+}
+
+
+std::size_t
+MemoryBudget::getBlockSize(std::size_t size) const noexcept
+{
+    return upstream_ == nullptr ? size : upstream_->getBlockSize(size);
+}
+
+
+void
+MemoryBudget::setLimit(std::size_t limit)
+{
+    limit_ = limit;
+    event_.trigger();
+}
+
+
+void
+MemoryBudget::waitForRoom(std::size_t size, int timeout)
+{
+    Deadline deadline(timeout);
+
+    while (usedByteCount_ >= 1 && !hasRoom(size)) {
+        if (!event_.waitFor(deadline.getRemainingTime())) {
+            throw GINK_SYSTEM_ERROR(ETIMEDOUT, "memory budget exceeded");
+        }
+    }
+}
+
+} // namespace Gink
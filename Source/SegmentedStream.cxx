@@ -0,0 +1,196 @@
+#include "SegmentedStream.h"
+
+#include <cstring>
+#include <algorithm>
+
+
+namespace Gink {
+
+int
+SegmentedStream::getData(::iovec *vector, int vectorLength) const
+{
+    std::size_t dataSize = dataSize_;
+    std::size_t j = 0;
+    int i = 0;
+
+    while (i < vectorLength && dataSize >= 1) {
+        const Segment &segment = segments_[j++];
+        std::size_t segmentDataSize = segment.wIndex - segment.rIndex;
+
+        if (segmentDataSize >= 1) {
+            vector[i].iov_base = segment.getBase() + segment.rIndex;
+            vector[i].iov_len = segmentDataSize;
+            dataSize -= segmentDataSize;
+            ++i;
+        }
+    }
+
+    return i;
+}
+
+
+int
+SegmentedStream::getBuffer(::iovec *vector, int vectorLength)
+{
+    std::size_t j = wSegmentIndex_;
+    int i;
+
+    for (i = 0; i < vectorLength && j < segments_.size(); ++i, ++j) {
+        Segment &segment = segments_[j];
+        vector[i].iov_base = segment.getBase() + segment.wIndex;
+        vector[i].iov_len = segment.capacity - segment.wIndex;
+    }
+
+    return i;
+}
+
+
+std::size_t
+SegmentedStream::read(void *buffer, std::size_t bufferSize)
+{
+    std::size_t dataSize = std::min(dataSize_, bufferSize);
+    std::size_t i = 0;
+
+    while (i < dataSize) {
+        Segment &segment = segments_.front();
+        std::size_t segmentDataSize = std::min(segment.wIndex - segment.rIndex, dataSize - i);
+
+        if (buffer != nullptr) {
+            std::memcpy(static_cast<char *>(buffer) + i, segment.getBase() + segment.rIndex
+                        , segmentDataSize);
+        }
+
+        i += segmentDataSize;
+        segment.rIndex += segmentDataSize;
+        dataSize_ -= segmentDataSize;
+
+        if (segment.rIndex == segment.capacity) {
+            if (segment.base != nullptr) {
+                segment.capacity = segmentSize_;
+                segment.rIndex = 0;
+                segment.wIndex = 0;
+                segments_.push_back(std::move(segment));
+            }
+
+            segments_.pop_front();
+            --wSegmentIndex_;
+        }
+    }
+
+    if (dataSize_ == 0 && wSegmentIndex_ < segments_.size()) {
+        Segment &segment = segments_[wSegmentIndex_];
+        segment.rIndex = 0;
+        segment.wIndex = 0;
+    }
+
+    return dataSize;
+}
+
+
+void
+SegmentedStream::write(const void *data, std::size_t dataSize)
+{
+    growBuffer(dataSize);
+    std::size_t i = 0;
+
+    while (i < dataSize) {
+        Segment &segment = segments_[wSegmentIndex_];
+        std::size_t segmentBufferSize = std::min(segment.capacity - segment.wIndex, dataSize - i);
+
+        if (data != nullptr) {
+            std::memcpy(segment.base.get() + segment.wIndex, static_cast<const char *>(data) + i
+                        , segmentBufferSize);
+        }
+
+        i += segmentBufferSize;
+        segment.wIndex += segmentBufferSize;
+
+        if (segment.wIndex == segment.capacity) {
+            ++wSegmentIndex_;
+        }
+    }
+
+    dataSize_ += dataSize;
+}
+
+
+void
+SegmentedStream::write(const SharedBuffer &sharedBuffer)
+{
+    std::size_t size = sharedBuffer.getSize();
+
+    if (size == 0) {
+        return;
+    }
+
+    if (wSegmentIndex_ < segments_.size() && segments_[wSegmentIndex_].wIndex >= 1) {
+        Segment &segment = segments_[wSegmentIndex_];
+
+        if (segment.rIndex == segment.wIndex) {
+            segment.rIndex = 0;
+            segment.wIndex = 0;
+        } else {
+            segment.capacity = segment.wIndex;
+            ++wSegmentIndex_;
+        }
+    }
+
+    Segment segment;
+    segment.sharedBase = sharedBuffer;
+    segment.capacity = size;
+    segment.rIndex = 0;
+    segment.wIndex = size;
+
+    if (wSegmentIndex_ == segments_.size()) {
+        segments_.push_back(std::move(segment));
+    } else {
+        segments_.insert(segments_.begin() + wSegmentIndex_, std::move(segment));
+    }
+
+    ++wSegmentIndex_;
+    dataSize_ += size;
+}
+
+
+void
+SegmentedStream::growBuffer(std::size_t size)
+{
+    std::size_t bufferSize = getBufferSize();
+
+    while (bufferSize < size) {
+        Segment segment;
+        segment.base.reset(new char [segmentSize_]);
+        segment.capacity = segmentSize_;
+        segment.rIndex = 0;
+        segment.wIndex = 0;
+        segments_.push_back(std::move(segment));
+        bufferSize += segmentSize_;
+    }
+}
+
+
+void
+SegmentedStream::shrinkToFit()
+{
+    std::size_t numberOfSegments = wSegmentIndex_;
+
+    if (wSegmentIndex_ < segments_.size() && segments_[wSegmentIndex_].wIndex >= 1) {
+        ++numberOfSegments;
+    }
+
+    segments_.resize(numberOfSegments);
+    segments_.shrink_to_fit();
+}
+
+
+char *
+SegmentedStream::Segment::getBase() const
+{
+    if (base != nullptr) {
+        return base.get();
+    }
+
+    return const_cast<char *>(static_cast<const char *>(sharedBase.getData()));
+}
+
+} // namespace Gink
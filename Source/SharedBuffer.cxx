@@ -0,0 +1,23 @@
+#include "SharedBuffer.h"
+
+#include <cstring>
+
+#include "Stream.h"
+
+
+namespace Gink {
+
+SharedBuffer::SharedBuffer(const void *data, std::size_t dataSize)
+    : base_(new char [dataSize], std::default_delete<char []>()), size_(dataSize)
+{
+    std::memcpy(const_cast<char *>(base_.get()), data, dataSize);
+}
+
+
+SharedBuffer::SharedBuffer(Stream *stream)
+    : SharedBuffer(stream->getData(), stream->getDataSize())
+{
+    stream->read(nullptr, size_);
+}
+
+} // namespace Gink
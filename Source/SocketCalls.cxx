@@ -0,0 +1,105 @@
+#include "SocketCalls.h"
+
+#include <cerrno>
+
+#include <Pixy/IO.h>
+
+#include "GAIError.h"
+#include "IORing.h"
+#include "SystemError.h"
+
+
+namespace Gink {
+
+void
+XGetAddrInfo(const char *hostName, const char *serviceName, const ::addrinfo *hints
+             , ::addrinfo **result)
+{
+    int errorCode = ::GetAddrInfo(hostName, serviceName, hints, result);
+
+    if (errorCode != 0) {
+        throw GINK_GAI_ERROR(errorCode, "`::GetAddrInfo()` failed");
+    }
+}
+
+
+int
+XSocket(int domain, int type, int protocol)
+{
+    int fd = ::Socket(domain, type, protocol);
+
+    if (fd < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::Socket()` failed");
+    }
+
+    return fd;
+}
+
+
+void
+xsetsockopt(int sockfd, int level, int optname, const void *optval, ::socklen_t optlen)
+{
+    if (::setsockopt(sockfd, level, optname, optval, optlen) < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::setsockopt()` failed");
+    }
+}
+
+
+void
+xbind(int sockfd, const ::sockaddr *addr, ::socklen_t addrlen)
+{
+    if (::bind(sockfd, addr, addrlen) < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::bind()` failed");
+    }
+}
+
+
+void
+xlisten(int sockfd, int backlog)
+{
+    if (::listen(sockfd, backlog) < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::listen()` failed");
+    }
+}
+
+
+void
+XConnect(int fd, const ::sockaddr *name, ::socklen_t nameSize, int timeout)
+{
+    if (::Connect(fd, name, nameSize, timeout) < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::Connect()` failed");
+    }
+}
+
+
+int
+XAccept4(int fd, ::sockaddr *name, ::socklen_t *nameSize, int flags, int timeout)
+{
+    int subFD = IORing::Accept4(fd, name, nameSize, flags, timeout);
+
+    if (subFD < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::Accept4()` failed");
+    }
+
+    return subFD;
+}
+
+
+void
+xgetsockname(int sockfd, ::sockaddr *addr, ::socklen_t *addrlen)
+{
+    if (::getsockname(sockfd, addr, addrlen) < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::getsockname()` failed");
+    }
+}
+
+
+void
+xgetpeername(int sockfd, ::sockaddr *addr, ::socklen_t *addrlen)
+{
+    if (::getpeername(sockfd, addr, addrlen) < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::getpeername()` failed");
+    }
+}
+
+} // namespace Gink
@@ -2,6 +2,9 @@
 
 #include <cstring>
 #include <climits>
+#include <new>
+
+#include "Allocator.h"
 
 
 namespace Gink {
@@ -13,6 +16,12 @@ std::size_t NextPowerOfTwo(std::size_t);
 } // namespace
 
 
+Stream::~Stream()
+{
+    deallocate(base_, capacity_);
+}
+
+
 std::size_t
 Stream::read(void *buffer, std::size_t bufferSize)
 {
@@ -22,14 +31,23 @@ Stream::read(void *buffer, std::size_t bufferSize)
         dataSize = bufferSize;
     }
 
-    if (buffer != nullptr) {
-        std::memcpy(buffer, base_.data() + rIndex_, dataSize);
+    if (buffer != nullptr && dataSize >= 1) {
+        std::memcpy(buffer, base_ + rIndex_, dataSize);
     }
 
     rIndex_ += dataSize;
 
-    if (rIndex_ >= wIndex_ - rIndex_) {
-        std::memcpy(base_.data(), base_.data() + rIndex_, wIndex_ - rIndex_);
+    if (rIndex_ == wIndex_ && allocator_ != nullptr) {
+        deallocate(base_, capacity_);
+        base_ = nullptr;
+        capacity_ = 0;
+        rIndex_ = 0;
+        wIndex_ = 0;
+        return dataSize;
+    }
+
+    if (rIndex_ >= 1 && rIndex_ >= wIndex_ - rIndex_) {
+        std::memmove(base_, base_ + rIndex_, wIndex_ - rIndex_);
         wIndex_ -= rIndex_;
         rIndex_ = 0;
     }
@@ -41,12 +59,12 @@ Stream::read(void *buffer, std::size_t bufferSize)
 void
 Stream::write(const void *data, std::size_t dataSize)
 {
-    if (base_.size() < wIndex_ + dataSize) {
-        base_.resize(NextPowerOfTwo(wIndex_ + dataSize));
+    if (capacity_ < wIndex_ + dataSize) {
+        reallocate(NextPowerOfTwo(wIndex_ - rIndex_ + dataSize));
     }
 
-    if (data != nullptr) {
-        std::memcpy(base_.data() + wIndex_, data, dataSize);
+    if (data != nullptr && dataSize >= 1) {
+        std::memcpy(base_ + wIndex_, data, dataSize);
     }
 
     wIndex_ += dataSize;
@@ -56,21 +74,66 @@ Stream::write(const void *data, std::size_t dataSize)
 void
 Stream::growBuffer(std::size_t size)
 {
-    base_.resize(NextPowerOfTwo(base_.size() + size));
+    reallocate(NextPowerOfTwo(capacity_ - rIndex_ + size));
 }
 
 
 void
 Stream::shrinkToFit()
 {
-    if (rIndex_ >= 1) {
-        std::memmove(base_.data(), base_.data() + rIndex_, wIndex_ - rIndex_);
-        wIndex_ -= rIndex_;
-        rIndex_ = 0;
+    reallocate(wIndex_ - rIndex_);
+}
+
+
+void
+Stream::reallocate(std::size_t capacity)
+{
+    char *base = allocate(capacity);
+    std::size_t size = capacity_ - rIndex_;
+
+    if (size > capacity) {
+        size = capacity;
+    }
+
+    if (size >= 1) {
+        std::memcpy(base, base_ + rIndex_, size);
+    }
+
+    deallocate(base_, capacity_);
+    base_ = base;
+    capacity_ = capacity;
+    wIndex_ -= rIndex_;
+    rIndex_ = 0;
+}
+
+
+char *
+Stream::allocate(std::size_t size)
+{
+    if (size == 0) {
+        return nullptr;
+    }
+
+    if (allocator_ != nullptr) {
+        return static_cast<char *>(allocator_->allocate(size));
     }
 
-    base_.erase(base_.begin() + wIndex_, base_.end());
-    base_.shrink_to_fit();
+    return static_cast<char *>(::operator new(size));
+}
+
+
+void
+Stream::deallocate(char *base, std::size_t size) noexcept
+{
+    if (base == nullptr) {
+        return;
+    }
+
+    if (allocator_ != nullptr) {
+        allocator_->deallocate(base, size);
+    } else {
+        ::operator delete(base);
+    }
 }
 
 
@@ -0,0 +1,325 @@
+#include "StreamSocket.h"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cassert>
+
+#include <Pixy/IO.h>
+#include <Pixy/Runtime.h>
+
+#include "Deadline.h"
+#include "IORing.h"
+#include "SystemError.h"
+#include "SegmentedStream.h"
+#include "Stream.h"
+
+
+namespace Gink {
+
+namespace {
+
+::size_t XReadV(int, const ::iovec *, int, int);
+::size_t XWriteV(int, const ::iovec *, int, int);
+void xshutdown(int, int);
+
+const int MaxVectorLength = 16;
+const std::size_t MaxAcceptBurst = 16;
+const int MaxGatherLength = 64;
+const std::size_t MinReadSize = 4096;
+const std::size_t InitialReadSize = 16384;
+const std::size_t MaxReadSize = 1048576;
+
+} // namespace
+
+
+StreamSocket::StreamSocket(int fd)
+    : fd_(fd), readSize_(InitialReadSize)
+{
+}
+
+
+StreamSocket::~StreamSocket()
+{
+    if (fd_ >= 0) {
+        ::Close(fd_);
+    }
+}
+
+
+// Waits only until the first connection is adopted, then takes what is already queued. `adopt`
+// owns each new fd and returns 0, or an error number if it had to drop the connection.
+std::size_t
+StreamSocket::accept(::sockaddr *name, ::socklen_t nameSize, std::size_t maxNumberOfSubFDs
+                     , int timeout, const std::function<int (int)> &adopt) const
+{
+    assert(maxNumberOfSubFDs >= 1);
+    Deadline deadline(timeout);
+    std::size_t numberOfSubFDs = 0;
+    std::size_t numberOfAccepts = 0;
+
+    while (numberOfSubFDs < maxNumberOfSubFDs) {
+        ::socklen_t subNameSize = nameSize;
+        int subFD = IORing::Accept4(fd_, name, name == nullptr ? nullptr : &subNameSize, 0
+                                    , numberOfSubFDs == 0 ? deadline.getRemainingTime() : 0);
+
+        if (subFD < 0) {
+            if (numberOfSubFDs >= 1) {
+                return numberOfSubFDs;
+            }
+
+            throw GINK_SYSTEM_ERROR(errno, "`::Accept4()` failed");
+        }
+
+        if (adopt(subFD) == 0) {
+            ++numberOfSubFDs;
+        }
+
+        if (++numberOfAccepts % MaxAcceptBurst == 0) {
+            ::YieldCurrentFiber();
+        }
+    }
+
+    return numberOfSubFDs;
+}
+
+
+std::size_t
+StreamSocket::read(Stream *stream, int timeout) const
+{
+    std::size_t numberOfBytes;
+    int errorNumber = tryRead(stream, &numberOfBytes, timeout);
+
+    if (errorNumber != 0) {
+        throw GINK_SYSTEM_ERROR(errorNumber, "`::Read()` failed");
+    }
+
+    return numberOfBytes;
+}
+
+
+std::size_t
+StreamSocket::write(Stream *stream, int timeout) const
+{
+    std::size_t numberOfBytes;
+    int errorNumber = tryWrite(stream, &numberOfBytes, timeout);
+
+    if (errorNumber != 0) {
+        throw GINK_SYSTEM_ERROR(errorNumber, "`::Write()` failed");
+    }
+
+    return numberOfBytes;
+}
+
+
+int
+StreamSocket::tryRead(Stream *stream, std::size_t *numberOfBytes, int timeout) const
+{
+    assert(stream != nullptr);
+    assert(numberOfBytes != nullptr);
+    std::size_t readSize = readSize_.load(std::memory_order_relaxed);
+    std::size_t bufferSize = stream->getBufferSize();
+
+    if (bufferSize < readSize) {
+        stream->growBuffer(readSize - bufferSize);
+        bufferSize = stream->getBufferSize();
+    }
+
+    ::ssize_t result = IORing::Read(fd_, stream->getBuffer(), bufferSize, timeout);
+
+    if (result < 0) {
+        *numberOfBytes = 0;
+        return errno;
+    }
+
+    stream->write(nullptr, result);
+    updateReadSize(readSize, bufferSize, result);
+    *numberOfBytes = result;
+    return 0;
+}
+
+
+int
+StreamSocket::tryWrite(Stream *stream, std::size_t *numberOfBytes, int timeout) const
+{
+    assert(stream != nullptr);
+    assert(numberOfBytes != nullptr);
+    const void *data = stream->getData();
+    std::size_t dataSize = stream->getDataSize();
+    std::size_t i = 0;
+    int errorNumber = 0;
+
+    while (i < dataSize) {
+        ::ssize_t result = IORing::Write(fd_, static_cast<const char *>(data) + i
+                                         , dataSize - i, timeout);
+
+        if (result < 0) {
+            errorNumber = errno;
+            break;
+        }
+
+        i += result;
+    }
+
+    if (i >= 1) {
+        stream->read(nullptr, i);
+    }
+
+    *numberOfBytes = i;
+    return errorNumber;
+}
+
+
+std::size_t
+StreamSocket::write(Stream *const *streams, std::size_t numberOfStreams, int timeout) const
+{
+    assert(streams != nullptr || numberOfStreams == 0);
+    std::size_t totalNumberOfBytes = 0;
+    std::size_t i = 0;
+
+    for (;;) {
+        while (i < numberOfStreams && streams[i]->getDataSize() == 0) {
+            ++i;
+        }
+
+        if (i == numberOfStreams) {
+            return totalNumberOfBytes;
+        }
+
+        ::iovec vector[MaxGatherLength];
+        int vectorLength = 0;
+        std::size_t j;
+
+        for (j = i; j < numberOfStreams && vectorLength < MaxGatherLength; ++j) {
+            std::size_t dataSize = streams[j]->getDataSize();
+
+            if (dataSize >= 1) {
+                vector[vectorLength].iov_base = streams[j]->getData();
+                vector[vectorLength].iov_len = dataSize;
+                ++vectorLength;
+            }
+        }
+
+        ::size_t numberOfBytes = XWriteV(fd_, vector, vectorLength, timeout);
+        totalNumberOfBytes += numberOfBytes;
+
+        for (j = i; numberOfBytes >= 1; ++j) {
+            numberOfBytes -= streams[j]->read(nullptr, numberOfBytes);
+        }
+    }
+}
+
+
+std::size_t
+StreamSocket::read(SegmentedStream *stream, int timeout) const
+{
+    assert(stream != nullptr);
+    std::size_t readSize = readSize_.load(std::memory_order_relaxed);
+    // The first segment may be partly filled, so one vector is kept for it.
+    std::size_t maxBufferSize = (MaxVectorLength - 1) * stream->getSegmentSize();
+    stream->growBuffer(std::min(std::max(readSize, stream->getSegmentSize()), maxBufferSize));
+    ::iovec vector[MaxVectorLength];
+    int vectorLength = stream->getBuffer(vector, MaxVectorLength);
+    std::size_t bufferSize = 0;
+    int i;
+
+    for (i = 0; i < vectorLength; ++i) {
+        bufferSize += vector[i].iov_len;
+    }
+
+    ::size_t numberOfBytes = XReadV(fd_, vector, vectorLength, timeout);
+    stream->write(nullptr, numberOfBytes);
+    updateReadSize(readSize, bufferSize, numberOfBytes);
+    return numberOfBytes;
+}
+
+
+std::size_t
+StreamSocket::write(SegmentedStream *stream, int timeout) const
+{
+    assert(stream != nullptr);
+    std::size_t dataSize = stream->getDataSize();
+
+    if (dataSize == 0) {
+        return 0;
+    }
+
+    do {
+        ::iovec vector[MaxVectorLength];
+        int vectorLength = stream->getData(vector, MaxVectorLength);
+        stream->read(nullptr, XWriteV(fd_, vector, vectorLength, timeout));
+    } while (stream->getDataSize() >= 1);
+
+    return dataSize;
+}
+
+
+void
+StreamSocket::shutdownRead() const
+{
+    xshutdown(fd_, SHUT_RD);
+}
+
+
+void
+StreamSocket::shutdownWrite() const
+{
+    xshutdown(fd_, SHUT_WR);
+}
+
+
+void
+StreamSocket::updateReadSize(std::size_t readSize, std::size_t bufferSize
+                             , std::size_t numberOfBytes) const
+{
+    if (numberOfBytes == bufferSize) {
+        readSize = std::min(std::max(readSize, bufferSize) * 2, MaxReadSize);
+    } else {
+        readSize = std::max((readSize * 3 + numberOfBytes) / 4, MinReadSize);
+    }
+
+    readSize_.store(readSize, std::memory_order_relaxed);
+}
+
+
+namespace {
+
+::size_t
+XReadV(int fd, const ::iovec *vector, int vectorLength, int timeout)
+{
+    ::ssize_t numberOfBytes = IORing::ReadV(fd, vector, vectorLength, timeout);
+
+    if (numberOfBytes < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::ReadV()` failed");
+    }
+
+    return numberOfBytes;
+}
+
+
+::size_t
+XWriteV(int fd, const ::iovec *vector, int vectorLength, int timeout)
+{
+    ::ssize_t numberOfBytes = IORing::WriteV(fd, vector, vectorLength, timeout);
+
+    if (numberOfBytes < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::WriteV()` failed");
+    }
+
+    return numberOfBytes;
+}
+
+
+void
+xshutdown(int sockfd, int how)
+{
+    if (::shutdown(sockfd, how) < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::shutdown()` failed");
+    }
+}
+
+} // namespace
+
+} // namespace Gink
@@ -5,14 +5,34 @@
 
 namespace Gink {
 
-SystemError::SystemError(int errorNumber, const char *description)
-    : errorNumber_(errorNumber), description_(description)
+SystemError::SystemError(int errorNumber, const char *location)
+    : errorNumber_(errorNumber), location_(location)
 {
-    if (errorNumber_ != 0) {
-        description_.push_back(':');
-        description_.push_back(' ');
-        description_ += std::strerror(errorNumber_);
+}
+
+
+// The description is formatted on first use, so that throwing stays cheap.
+const char *
+SystemError::what() const noexcept
+{
+    if (!description_.empty()) {
+        return description_.c_str();
     }
+
+    try {
+        description_ = location_;
+
+        if (errorNumber_ != 0) {
+            description_.push_back(':');
+            description_.push_back(' ');
+            description_ += std::strerror(errorNumber_);
+        }
+    } catch (...) {
+        description_.clear();
+        return location_;
+    }
+
+    return description_.c_str();
 }
 
 } // namespace Gink
@@ -1,43 +1,37 @@
 #include "TCPSocket.h"
 
+#include <linux/filter.h>
 #include <netdb.h>
 #include <netinet/tcp.h>
-#include <sys/uio.h>
 
 #include <cstring>
 #include <cerrno>
 #include <cassert>
+#include <utility>
 
 #include <Pixy/IO.h>
 
 #include "ScopeGuard.h"
-#include "GAIError.h"
+#include "IORing.h"
+#include "SocketCalls.h"
 #include "SystemError.h"
-#include "Stream.h"
 
 
 namespace Gink {
 
 namespace {
 
-void XGetAddrInfo(const char *, const char *, const ::addrinfo *, ::addrinfo **);
-int XSocket(int, int, int);
-void xsetsockopt(int, int, int, const void *, ::socklen_t);
-void xbind(int, const ::sockaddr *, ::socklen_t);
-void xlisten(int, int);
-void XConnect(int, const ::sockaddr *, ::socklen_t, int);
-int XAccept4(int, ::sockaddr *, ::socklen_t *, int, int);
-::size_t XReadV(int, const ::iovec *, int, int);
-::size_t XWrite(int, const void *, ::size_t, int);
-void xshutdown(int, int);
-void xgetsockname(int, ::sockaddr *, ::socklen_t *);
-void xgetpeername(int, ::sockaddr *, ::socklen_t *);
+int ListenFD(int, int, int, const ::sockaddr *, ::socklen_t, bool, int, const SocketOptions *);
+void ApplyOptions(int, const SocketOptions &, bool);
+int TryApplyOptions(int, const SocketOptions &, bool);
+void AttachCPUSteering(int, int);
 
 } // namespace
 
 
 TCPSocket
-TCPSocket::Listen(const char *hostName, const char *serviceName, int backlog)
+TCPSocket::Listen(const char *hostName, const char *serviceName, int backlog
+                  , const SocketOptions *options)
 {
     ::addrinfo hints;
     std::memset(&hints, 0, sizeof hints);
@@ -46,26 +40,59 @@ TCPSocket::Listen(const char *hostName, const char *serviceName, int backlog)
     hints.ai_socktype = SOCK_STREAM;
     hints.ai_protocol = IPPROTO_TCP;
     ::addrinfo *result;
-    ScopeGuard scopeGuard1([&result] { ::freeaddrinfo(result); });
+    ScopeGuard scopeGuard([&result] { ::freeaddrinfo(result); });
     XGetAddrInfo(hostName, serviceName, &hints, &result);
-    scopeGuard1.appoint();
-    int fd;
-    ScopeGuard scopeGuard2([&fd] { ::Close(fd); });
-    fd = XSocket(result->ai_family, result->ai_socktype, result->ai_protocol);
-    scopeGuard2.appoint();
-    int onOff = 1;
-    xsetsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &onOff, sizeof onOff);
-    xsetsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &onOff, sizeof onOff);
-    xbind(fd, result->ai_addr, result->ai_addrlen);
-    xlisten(fd, backlog);
-    TCPSocket instance(fd);
-    scopeGuard2.dismiss();
-    return instance;
+    scopeGuard.appoint();
+    return TCPSocket(ListenFD(result->ai_family, result->ai_socktype, result->ai_protocol
+                              , result->ai_addr, result->ai_addrlen, false, backlog, options));
+}
+
+
+std::vector<TCPSocket>
+TCPSocket::ListenSharded(const char *hostName, const char *serviceName, int numberOfShards
+                         , bool steersByCPU, int backlog, const SocketOptions *options)
+{
+    assert(numberOfShards >= 1);
+    ::addrinfo hints;
+    std::memset(&hints, 0, sizeof hints);
+    hints.ai_flags = AI_PASSIVE;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    ::addrinfo *result;
+    ScopeGuard scopeGuard([&result] { ::freeaddrinfo(result); });
+    XGetAddrInfo(hostName, serviceName, &hints, &result);
+    scopeGuard.appoint();
+    std::vector<TCPSocket> instances;
+    instances.reserve(numberOfShards);
+    ::sockaddr_in name;
+    ::socklen_t nameSize = sizeof name;
+    std::memcpy(&name, result->ai_addr, nameSize);
+    int i;
+
+    for (i = 0; i < numberOfShards; ++i) {
+        instances.push_back(TCPSocket(ListenFD(result->ai_family, result->ai_socktype
+                                               , result->ai_protocol
+                                               , reinterpret_cast<::sockaddr *>(&name)
+                                               , nameSize, true, backlog, options)));
+
+        if (i == 0) {
+            xgetsockname(instances[0].socket_.getFD(), reinterpret_cast<::sockaddr *>(&name)
+                         , &nameSize);
+        }
+    }
+
+    if (steersByCPU) {
+        AttachCPUSteering(instances[0].socket_.getFD(), numberOfShards);
+    }
+
+    return instances;
 }
 
 
 TCPSocket
-TCPSocket::Connect(const char *hostName, const char *serviceName, int timeout)
+TCPSocket::Connect(const char *hostName, const char *serviceName, int timeout
+                   , const SocketOptions *options)
 {
     ::addrinfo hints;
     std::memset(&hints, 0, sizeof hints);
@@ -80,6 +107,11 @@ TCPSocket::Connect(const char *hostName, const char *serviceName, int timeout)
     ScopeGuard scopeGuard2([&fd] { ::Close(fd); });
     fd = XSocket(result->ai_family, result->ai_socktype, result->ai_protocol);
     scopeGuard2.appoint();
+
+    if (options != nullptr) {
+        ApplyOptions(fd, *options, false);
+    }
+
     XConnect(fd, result->ai_addr, result->ai_addrlen, timeout);
     TCPSocket instance(fd);
     scopeGuard2.dismiss();
@@ -87,103 +119,116 @@ TCPSocket::Connect(const char *hostName, const char *serviceName, int timeout)
 }
 
 
-TCPSocket::TCPSocket(int fd)
-    : fd_(fd)
+TCPSocket
+TCPSocket::Connect(const IPEndpoint &endpoint, int timeout, const SocketOptions *options)
 {
+    ::sockaddr_in name;
+    endpoint.get(&name);
+    int fd;
+    ScopeGuard scopeGuard([&fd] { ::Close(fd); });
+    fd = XSocket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    scopeGuard.appoint();
+
+    if (options != nullptr) {
+        ApplyOptions(fd, *options, false);
+    }
+
+    XConnect(fd, reinterpret_cast<::sockaddr *>(&name), sizeof name, timeout);
+    TCPSocket instance(fd);
+    scopeGuard.dismiss();
+    return instance;
 }
 
 
-TCPSocket::~TCPSocket()
+TCPSocket::TCPSocket(int fd)
+    : socket_(fd)
 {
-    if (fd_ >= 0) {
-        ::Close(fd_);
-    }
 }
 
 
 TCPSocket
-TCPSocket::accept(IPEndpoint *endpoint, int timeout) const
+TCPSocket::accept(IPEndpoint *endpoint, int timeout, const SocketOptions *options) const
 {
-    int subFD;
-    ScopeGuard scopeGuard([&subFD] { ::Close(subFD); });
     ::sockaddr_in name;
     ::socklen_t nameSize = sizeof name;
-    subFD = XAccept4(fd_, reinterpret_cast<::sockaddr *>(&name), &nameSize, 0, timeout);
-    scopeGuard.appoint();
+    TCPSocket instance(XAccept4(socket_.getFD(), reinterpret_cast<::sockaddr *>(&name), &nameSize, 0
+                                , timeout));
+
+    if (options != nullptr) {
+        ApplyOptions(instance.socket_.getFD(), *options, false);
+    }
 
     if (endpoint != nullptr) {
         endpoint->set(name);
     }
 
-    TCPSocket instance(subFD);
-    scopeGuard.dismiss();
     return instance;
 }
 
 
 std::size_t
-TCPSocket::read(Stream *stream, int timeout) const
+TCPSocket::accept(std::vector<TCPSocket> *instances, std::size_t maxNumberOfInstances
+                  , IPEndpoint *endpoints, int timeout, const SocketOptions *options) const
 {
-    assert(stream != nullptr);
-    void *buffer1 = stream->getBuffer();
-    std::size_t buffer1Size = stream->getBufferSize();
-    static char buffer2[65536];
-
-    ::iovec vector[2] = {
-        {buffer1, buffer1Size},
-        {buffer2, sizeof buffer2}
-    };
+    assert(instances != nullptr);
+    ::sockaddr_in name;
+    std::size_t i = 0;
 
-    ::size_t numberOfBytes = XReadV(fd_, vector, 2, timeout);
+    return socket_.accept(reinterpret_cast<::sockaddr *>(&name), sizeof name
+                          , maxNumberOfInstances, timeout, [&] (int subFD) -> int {
+        TCPSocket instance(subFD);
 
-    if (numberOfBytes == 0) {
-        return 0;
-    }
+        if (options != nullptr) {
+            int errorNumber = TryApplyOptions(subFD, *options, false);
 
-    if (numberOfBytes < buffer1Size) {
-        stream->write(nullptr, numberOfBytes);
-    } else {
-        stream->write(nullptr, buffer1Size);
-        stream->write(buffer2, numberOfBytes - buffer1Size);
-    }
+            if (errorNumber != 0) {
+                return errorNumber;
+            }
+        }
+
+        instances->push_back(std::move(instance));
 
-    return numberOfBytes;
+        if (endpoints != nullptr) {
+            endpoints[i].set(name);
+        }
+
+        ++i;
+        return 0;
+    });
 }
 
 
-std::size_t
-TCPSocket::write(Stream *stream, int timeout) const
+int
+TCPSocket::tryAccept(std::vector<TCPSocket> *instances, IPEndpoint *endpoint, int timeout
+                     , const SocketOptions *options) const
 {
-    assert(stream != nullptr);
-    const void *data = stream->getData();
-    std::size_t dataSize = stream->getDataSize();
+    assert(instances != nullptr);
+    ::sockaddr_in name;
+    ::socklen_t nameSize = sizeof name;
+    int subFD = IORing::Accept4(socket_.getFD(), reinterpret_cast<::sockaddr *>(&name), &nameSize, 0
+                                , timeout);
 
-    if (dataSize == 0) {
-        return 0;
+    if (subFD < 0) {
+        return errno;
     }
 
-    std::ptrdiff_t i = 0;
+    TCPSocket instance(subFD);
 
-    do {
-        i += XWrite(fd_, static_cast<const char *>(data) + i, dataSize - i, timeout);
-    } while (i < static_cast<std::ptrdiff_t>(dataSize));
+    if (options != nullptr) {
+        int errorNumber = TryApplyOptions(subFD, *options, false);
 
-    stream->read(nullptr, i);
-    return i;
-}
+        if (errorNumber != 0) {
+            return errorNumber;
+        }
+    }
 
+    instances->push_back(std::move(instance));
 
-void
-TCPSocket::shutdownRead() const
-{
-    xshutdown(fd_, SHUT_RD);
-}
-
+    if (endpoint != nullptr) {
+        endpoint->set(name);
+    }
 
-void
-TCPSocket::shutdownWrite() const
-{
-    xshutdown(fd_, SHUT_WR);
+    return 0;
 }
 
 
@@ -192,7 +237,7 @@ TCPSocket::getLocalEndpoint() const
 {
     ::sockaddr_in name;
     ::socklen_t nameSize = sizeof name;
-    xgetsockname(fd_, reinterpret_cast<::sockaddr *>(&name), &nameSize);
+    xgetsockname(socket_.getFD(), reinterpret_cast<::sockaddr *>(&name), &nameSize);
     return IPEndpoint(name);
 }
 
@@ -202,137 +247,127 @@ TCPSocket::getRemoteEndpoint() const
 {
     ::sockaddr_in name;
     ::socklen_t nameSize = sizeof name;
-    xgetpeername(fd_, reinterpret_cast<::sockaddr *>(&name), &nameSize);
+    xgetpeername(socket_.getFD(), reinterpret_cast<::sockaddr *>(&name), &nameSize);
     return IPEndpoint(name);
 }
 
 
-namespace {
-
 void
-XGetAddrInfo(const char *hostName, const char *serviceName, const ::addrinfo *hints
-             , ::addrinfo **result)
+TCPSocket::setOptions(const SocketOptions &options) const
 {
-    int errorCode = ::GetAddrInfo(hostName, serviceName, hints, result);
+    int isListening = 0;
+    ::socklen_t isListeningSize = sizeof isListening;
 
-    if (errorCode != 0) {
-        throw GINK_GAI_ERROR(errorCode, "`::GetAddrInfo()` failed");
+    if (::getsockopt(socket_.getFD(), SOL_SOCKET, SO_ACCEPTCONN, &isListening
+                     , &isListeningSize) < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::getsockopt()` failed");
     }
-}
 
-
-int
-XSocket(int domain, int type, int protocol)
-{
-    int fd = ::Socket(domain, type, protocol);
-
-    if (fd < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::Socket()` failed");
-    }
-
-    return fd;
+    ApplyOptions(socket_.getFD(), options, isListening != 0);
 }
 
 
-void
-xsetsockopt(int sockfd, int level, int optname, const void *optval, ::socklen_t optlen)
+bool
+TCPSocket::isReusable() const
 {
-    if (::setsockopt(sockfd, level, optname, optval, optlen) < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::setsockopt()` failed");
-    }
+    char byte;
+    ::ssize_t numberOfBytes = ::recv(socket_.getFD(), &byte, sizeof byte
+                                     , MSG_PEEK | MSG_DONTWAIT);
+    return numberOfBytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
 }
 
 
-void
-xbind(int sockfd, const ::sockaddr *addr, ::socklen_t addrlen)
-{
-    if (::bind(sockfd, addr, addrlen) < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::bind()` failed");
-    }
-}
-
+namespace {
 
-void
-xlisten(int sockfd, int backlog)
+int
+ListenFD(int domain, int type, int protocol, const ::sockaddr *name, ::socklen_t nameSize
+         , bool reusesPort, int backlog, const SocketOptions *options)
 {
-    if (::listen(sockfd, backlog) < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::listen()` failed");
-    }
-}
-
+    int fd;
+    ScopeGuard scopeGuard([&fd] { ::Close(fd); });
+    fd = XSocket(domain, type, protocol);
+    scopeGuard.appoint();
+    int onOff = 1;
+    xsetsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &onOff, sizeof onOff);
 
-void
-XConnect(int fd, const ::sockaddr *name, ::socklen_t nameSize, int timeout)
-{
-    if (::Connect(fd, name, nameSize, timeout) < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::Connect()` failed");
+    if (reusesPort) {
+        xsetsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &onOff, sizeof onOff);
     }
-}
 
+    SocketOptions listenOptions;
 
-int
-XAccept4(int fd, ::sockaddr *name, ::socklen_t *nameSize, int flags, int timeout)
-{
-    int subFD = ::Accept4(fd, name, nameSize, flags, timeout);
+    if (options != nullptr) {
+        listenOptions = *options;
+    }
 
-    if (subFD < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::Accept4()` failed");
+    if (listenOptions.noDelay < 0) {
+        listenOptions.noDelay = 1;
     }
 
-    return subFD;
+    ApplyOptions(fd, listenOptions, true);
+    xbind(fd, name, nameSize);
+    xlisten(fd, backlog);
+    scopeGuard.dismiss();
+    return fd;
 }
 
 
-::size_t
-XReadV(int fd, const ::iovec *vector, int vectorLength, int timeout)
+void
+ApplyOptions(int fd, const SocketOptions &options, bool isListening)
 {
-    ::ssize_t numberOfBytes = ::ReadV(fd, vector, vectorLength, timeout);
+    int errorNumber = TryApplyOptions(fd, options, isListening);
 
-    if (numberOfBytes < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::ReadV()` failed");
+    if (errorNumber != 0) {
+        throw GINK_SYSTEM_ERROR(errorNumber, "`::setsockopt()` failed");
     }
-
-    return numberOfBytes;
 }
 
 
-::size_t
-XWrite(int fd, const void *data, ::size_t dataSize, int timeout)
+int
+TryApplyOptions(int fd, const SocketOptions &options, bool isListening)
 {
-    ::ssize_t numberOfBytes = ::Write(fd, data, dataSize, timeout);
+    const struct {
+        int value;
+        int level;
+        int name;
+    } entries[] = {
+        {options.sendBufferSize, SOL_SOCKET, SO_SNDBUF},
+        {options.receiveBufferSize, SOL_SOCKET, SO_RCVBUF},
+        {options.noDelay, IPPROTO_TCP, TCP_NODELAY},
+        {options.cork, IPPROTO_TCP, TCP_CORK},
+        {options.quickAck, IPPROTO_TCP, TCP_QUICKACK},
+        {options.fastOpen, IPPROTO_TCP, isListening ? TCP_FASTOPEN : TCP_FASTOPEN_CONNECT},
+        {options.busyPollTime, SOL_SOCKET, SO_BUSY_POLL},
+        {options.userTimeout, IPPROTO_TCP, TCP_USER_TIMEOUT},
+        {options.keepAlive, SOL_SOCKET, SO_KEEPALIVE},
+        {options.keepAliveIdleTime, IPPROTO_TCP, TCP_KEEPIDLE},
+        {options.keepAliveInterval, IPPROTO_TCP, TCP_KEEPINTVL},
+        {options.keepAliveCount, IPPROTO_TCP, TCP_KEEPCNT},
+        {isListening ? options.deferAcceptTime : -1, IPPROTO_TCP, TCP_DEFER_ACCEPT}
+    };
 
-    if (numberOfBytes < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::Write()` failed");
+    for (const auto &entry: entries) {
+        if (entry.value >= 0
+            && ::setsockopt(fd, entry.level, entry.name, &entry.value, sizeof entry.value) < 0) {
+            return errno;
+        }
     }
 
-    return numberOfBytes;
-}
-
-
-void
-xshutdown(int sockfd, int how)
-{
-    if (::shutdown(sockfd, how) < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::shutdown()` failed");
-    }
+    return 0;
 }
 
 
 void
-xgetsockname(int sockfd, ::sockaddr *addr, ::socklen_t *addrlen)
+AttachCPUSteering(int fd, int numberOfShards)
 {
-    if (::getsockname(sockfd, addr, addrlen) < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::getsockname()` failed");
-    }
-}
-
+    ::sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<__u32>(SKF_AD_OFF + SKF_AD_CPU)},
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<__u32>(numberOfShards)},
+        {BPF_RET | BPF_A, 0, 0, 0}
+    };
 
-void
-xgetpeername(int sockfd, ::sockaddr *addr, ::socklen_t *addrlen)
-{
-    if (::getpeername(sockfd, addr, addrlen) < 0) {
-        throw GINK_SYSTEM_ERROR(errno, "`::getpeername()` failed");
-    }
+    ::sock_fprog program = {sizeof code / sizeof code[0], code};
+    xsetsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof program);
 }
 
 } // namespace
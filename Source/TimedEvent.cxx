@@ -0,0 +1,87 @@
+#include "TimedEvent.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+
+#include <Pixy/IO.h>
+
+#include "ScopeGuard.h"
+#include "SystemError.h"
+
+
+namespace Gink {
+
+struct TimedEvent::Waiter
+{
+    int fd;
+    Waiter *prev;
+    Waiter *next;
+};
+
+
+void
+TimedEvent::trigger() noexcept
+{
+    for (Waiter *waiter = firstWaiter_; waiter != nullptr; waiter = waiter->next) {
+        ::eventfd_write(waiter->fd, 1);
+    }
+}
+
+
+bool
+TimedEvent::waitFor(int timeout)
+{
+    if (timeout == 0) {
+        return false;
+    }
+
+    Waiter waiter;
+    waiter.fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (waiter.fd < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::eventfd()` failed");
+    }
+
+    ScopeGuard scopeGuard1([&waiter] { ::close(waiter.fd); });
+    scopeGuard1.appoint();
+    waiter.prev = nullptr;
+    waiter.next = firstWaiter_;
+
+    if (firstWaiter_ != nullptr) {
+        firstWaiter_->prev = &waiter;
+    }
+
+    firstWaiter_ = &waiter;
+
+    ScopeGuard scopeGuard2([this, &waiter] {
+        if (waiter.prev == nullptr) {
+            firstWaiter_ = waiter.next;
+        } else {
+            waiter.prev->next = waiter.next;
+        }
+
+        if (waiter.next != nullptr) {
+            waiter.next->prev = waiter.prev;
+        }
+    });
+
+    scopeGuard2.appoint();
+    std::uint64_t counter;
+
+    if (::Read(waiter.fd, &counter, sizeof counter, timeout) < 0) {
+        if (errno == ETIMEDOUT) {
+            return false;
+        }
+
+        if (errno != EINTR) {
+            throw GINK_SYSTEM_ERROR(errno, "`::Read()` failed");
+        }
+    }
+
+    return true;
+}
+
+} // namespace Gink
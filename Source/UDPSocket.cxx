@@ -0,0 +1,362 @@
+#include "UDPSocket.h"
+
+#include <netdb.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <cassert>
+#include <chrono>
+
+#include <Pixy/IO.h>
+#include <Pixy/Runtime.h>
+
+#include "ScopeGuard.h"
+#include "SocketCalls.h"
+#include "SystemError.h"
+#include "Stream.h"
+
+
+namespace Gink {
+
+namespace {
+
+union ControlBuffer
+{
+    char bytes[CMSG_SPACE(sizeof(int))];
+    ::cmsghdr header;
+};
+
+
+void WaitForDatagram(int, int);
+int GetRemainingTime(std::chrono::steady_clock::time_point, int);
+void SendMessages(int, ::mmsghdr *, int, int, int *);
+void ConsumeMessages(Stream *const *, const std::size_t *, const ::iovec *, int);
+std::size_t GetSegmentSize(const ::mmsghdr &);
+
+const int MaxBatchSize = 64;
+const std::size_t MaxDatagramSize = 65536;
+const std::size_t MaxPayloadSize = 65507;
+const std::size_t MaxNumberOfSegments = 64;
+
+} // namespace
+
+
+UDPSocket
+UDPSocket::Bind(const char *hostName, const char *serviceName, bool usesGRO)
+{
+    ::addrinfo hints;
+    std::memset(&hints, 0, sizeof hints);
+    hints.ai_flags = AI_PASSIVE;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_protocol = IPPROTO_UDP;
+    ::addrinfo *result;
+    ScopeGuard scopeGuard1([&result] { ::freeaddrinfo(result); });
+    XGetAddrInfo(hostName, serviceName, &hints, &result);
+    scopeGuard1.appoint();
+    int fd;
+    ScopeGuard scopeGuard2([&fd] { ::Close(fd); });
+    fd = XSocket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    scopeGuard2.appoint();
+    xbind(fd, result->ai_addr, result->ai_addrlen);
+    int onOff = 1;
+    usesGRO = usesGRO && ::setsockopt(fd, SOL_UDP, UDP_GRO, &onOff, sizeof onOff) == 0;
+    int segmentSize = 0;
+    bool supportsGSO = ::setsockopt(fd, SOL_UDP, UDP_SEGMENT, &segmentSize
+                                    , sizeof segmentSize) == 0;
+    UDPSocket instance(fd, usesGRO, supportsGSO);
+    scopeGuard2.dismiss();
+    return instance;
+}
+
+
+UDPSocket::UDPSocket(int fd, bool usesGRO, bool supportsGSO)
+    : fd_(fd), usesGRO_(usesGRO), supportsGSO_(supportsGSO)
+{
+}
+
+
+UDPSocket::~UDPSocket()
+{
+    if (fd_ >= 0) {
+        ::Close(fd_);
+    }
+}
+
+
+std::size_t
+UDPSocket::receive(Stream *const *streams, IPEndpoint *endpoints, std::size_t numberOfStreams
+                   , std::size_t *segmentSizes, int timeout) const
+{
+    assert(streams != nullptr);
+    assert(numberOfStreams >= 1);
+    assert(!usesGRO_ || segmentSizes != nullptr);
+    int numberOfMessages = std::min(numberOfStreams, std::size_t(MaxBatchSize));
+    ::mmsghdr messages[MaxBatchSize];
+    ::iovec vectors[MaxBatchSize];
+    ::sockaddr_in names[MaxBatchSize];
+    ControlBuffer controlBuffers[MaxBatchSize];
+    int i;
+
+    for (i = 0; i < numberOfMessages; ++i) {
+        Stream *stream = streams[i];
+        std::size_t bufferSize = stream->getBufferSize();
+
+        if (bufferSize < MaxDatagramSize) {
+            stream->growBuffer(MaxDatagramSize - bufferSize);
+            bufferSize = stream->getBufferSize();
+        }
+
+        vectors[i].iov_base = stream->getBuffer();
+        vectors[i].iov_len = bufferSize;
+        ::msghdr *message = &messages[i].msg_hdr;
+        std::memset(message, 0, sizeof *message);
+        message->msg_name = &names[i];
+        message->msg_namelen = sizeof names[i];
+        message->msg_iov = &vectors[i];
+        message->msg_iovlen = 1;
+
+        if (usesGRO_) {
+            message->msg_control = &controlBuffers[i];
+            message->msg_controllen = sizeof controlBuffers[i];
+        }
+    }
+
+    std::chrono::steady_clock::time_point deadline;
+
+    if (timeout >= 1) {
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    }
+
+    int numberOfReceivedMessages;
+
+    for (;;) {
+        numberOfReceivedMessages = ::recvmmsg(fd_, messages, numberOfMessages, MSG_DONTWAIT
+                                              , nullptr);
+
+        if (numberOfReceivedMessages >= 0) {
+            break;
+        }
+
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            throw GINK_SYSTEM_ERROR(errno, "`::recvmmsg()` failed");
+        }
+
+        WaitForDatagram(fd_, GetRemainingTime(deadline, timeout));
+    }
+
+    for (i = 0; i < numberOfReceivedMessages; ++i) {
+        streams[i]->write(nullptr, messages[i].msg_len);
+
+        if (endpoints != nullptr) {
+            endpoints[i].set(names[i]);
+        }
+
+        if (segmentSizes != nullptr) {
+            segmentSizes[i] = GetSegmentSize(messages[i]);
+        }
+    }
+
+    if (numberOfReceivedMessages == MaxBatchSize) {
+        ::YieldCurrentFiber();
+    }
+
+    return numberOfReceivedMessages;
+}
+
+
+std::size_t
+UDPSocket::send(Stream *const *streams, const IPEndpoint *endpoints, std::size_t numberOfStreams
+                , std::size_t segmentSize, int timeout) const
+{
+    assert(streams != nullptr || numberOfStreams == 0);
+    assert(endpoints != nullptr || numberOfStreams == 0);
+    assert(segmentSize <= MaxPayloadSize);
+    std::size_t chunkSize;
+
+    if (segmentSize == 0) {
+        chunkSize = SIZE_MAX;
+    } else if (supportsGSO_) {
+        chunkSize = segmentSize * std::min(MaxPayloadSize / segmentSize, MaxNumberOfSegments);
+    } else {
+        chunkSize = segmentSize;
+    }
+
+    ::mmsghdr messages[MaxBatchSize];
+    ::iovec vectors[MaxBatchSize];
+    ::sockaddr_in names[MaxBatchSize];
+    ControlBuffer controlBuffers[MaxBatchSize];
+    std::size_t streamIndexes[MaxBatchSize];
+    std::size_t totalNumberOfBytes = 0;
+    std::size_t i = 0;
+
+    while (i < numberOfStreams) {
+        int numberOfMessages = 0;
+        std::size_t offset = 0;
+
+        do {
+            std::size_t dataSize = streams[i]->getDataSize();
+
+            // An empty stream has nothing to send, not a zero-length datagram.
+            if (dataSize == 0) {
+                ++i;
+                continue;
+            }
+
+            const char *data = static_cast<const char *>(streams[i]->getData());
+            std::size_t size = std::min(dataSize - offset, chunkSize);
+            vectors[numberOfMessages].iov_base = const_cast<char *>(data) + offset;
+            vectors[numberOfMessages].iov_len = size;
+            streamIndexes[numberOfMessages] = i;
+            endpoints[i].get(&names[numberOfMessages]);
+            ::msghdr *message = &messages[numberOfMessages].msg_hdr;
+            std::memset(message, 0, sizeof *message);
+            message->msg_name = &names[numberOfMessages];
+            message->msg_namelen = sizeof names[numberOfMessages];
+            message->msg_iov = &vectors[numberOfMessages];
+            message->msg_iovlen = 1;
+
+            if (segmentSize >= 1 && size > segmentSize) {
+                message->msg_control = &controlBuffers[numberOfMessages];
+                message->msg_controllen = CMSG_SPACE(sizeof(std::uint16_t));
+                ::cmsghdr *control = CMSG_FIRSTHDR(message);
+                control->cmsg_level = SOL_UDP;
+                control->cmsg_type = UDP_SEGMENT;
+                control->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+                std::uint16_t value = segmentSize;
+                std::memcpy(CMSG_DATA(control), &value, sizeof value);
+            }
+
+            ++numberOfMessages;
+            offset += size;
+            totalNumberOfBytes += size;
+
+            if (offset == dataSize) {
+                ++i;
+                offset = 0;
+            }
+        } while (i < numberOfStreams && numberOfMessages < MaxBatchSize);
+
+        if (numberOfMessages == 0) {
+            break;
+        }
+
+        int numberOfSentMessages = 0;
+
+        try {
+            SendMessages(fd_, messages, numberOfMessages, timeout, &numberOfSentMessages);
+        } catch (...) {
+            ConsumeMessages(streams, streamIndexes, vectors, numberOfSentMessages);
+            throw;
+        }
+
+        ConsumeMessages(streams, streamIndexes, vectors, numberOfMessages);
+    }
+
+    return totalNumberOfBytes;
+}
+
+
+IPEndpoint
+UDPSocket::getLocalEndpoint() const
+{
+    ::sockaddr_in name;
+    ::socklen_t nameSize = sizeof name;
+    xgetsockname(fd_, reinterpret_cast<::sockaddr *>(&name), &nameSize);
+    return IPEndpoint(name);
+}
+
+
+namespace {
+
+void
+WaitForDatagram(int fd, int timeout)
+{
+    ::msghdr message;
+    std::memset(&message, 0, sizeof message);
+
+    if (::RecvMsg(fd, &message, MSG_PEEK, timeout) < 0) {
+        throw GINK_SYSTEM_ERROR(errno, "`::RecvMsg()` failed");
+    }
+}
+
+
+int
+GetRemainingTime(std::chrono::steady_clock::time_point deadline, int timeout)
+{
+    if (timeout <= 0) {
+        return timeout;
+    }
+
+    auto remainingTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now()).count();
+
+    if (remainingTime <= 0) {
+        throw GINK_SYSTEM_ERROR(ETIMEDOUT, "`::RecvMsg()` failed");
+    }
+
+    return remainingTime;
+}
+
+
+void
+SendMessages(int fd, ::mmsghdr *messages, int numberOfMessages, int timeout
+             , int *numberOfSentMessages)
+{
+    while (*numberOfSentMessages < numberOfMessages) {
+        int i = *numberOfSentMessages;
+        int result = ::sendmmsg(fd, messages + i, numberOfMessages - i, MSG_DONTWAIT);
+
+        if (result < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                throw GINK_SYSTEM_ERROR(errno, "`::sendmmsg()` failed");
+            }
+
+            if (::SendMsg(fd, &messages[i].msg_hdr, 0, timeout) < 0) {
+                throw GINK_SYSTEM_ERROR(errno, "`::SendMsg()` failed");
+            }
+
+            result = 1;
+        }
+
+        *numberOfSentMessages += result;
+    }
+}
+
+
+void
+ConsumeMessages(Stream *const *streams, const std::size_t *streamIndexes, const ::iovec *vectors
+                , int numberOfMessages)
+{
+    for (int i = 0; i < numberOfMessages; ++i) {
+        if (vectors[i].iov_len >= 1) {
+            streams[streamIndexes[i]]->read(nullptr, vectors[i].iov_len);
+        }
+    }
+}
+
+
+std::size_t
+GetSegmentSize(const ::mmsghdr &message)
+{
+    for (const ::cmsghdr *control = CMSG_FIRSTHDR(&message.msg_hdr); control != nullptr
+         ; control = CMSG_NXTHDR(const_cast<::msghdr *>(&message.msg_hdr)
+                                 , const_cast<::cmsghdr *>(control))) {
+        if (control->cmsg_level == SOL_UDP && control->cmsg_type == UDP_GRO) {
+            int segmentSize;
+            std::memcpy(&segmentSize, CMSG_DATA(control), sizeof segmentSize);
+            return segmentSize;
+        }
+    }
+
+    return message.msg_len;
+}
+
+} // namespace
+
+} // namespace Gink
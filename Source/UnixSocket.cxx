@@ -0,0 +1,127 @@
+#include "UnixSocket.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <cassert>
+
+#include <Pixy/IO.h>
+
+#include "ScopeGuard.h"
+#include "IORing.h"
+#include "SocketCalls.h"
+#include "SystemError.h"
+
+
+namespace Gink {
+
+namespace {
+
+::socklen_t MakeName(const char *, ::sockaddr_un *);
+
+} // namespace
+
+
+UnixSocket
+UnixSocket::Listen(const char *path, int backlog)
+{
+    ::sockaddr_un name;
+    ::socklen_t nameSize = MakeName(path, &name);
+    int fd;
+    ScopeGuard scopeGuard([&fd] { ::Close(fd); });
+    fd = XSocket(AF_UNIX, SOCK_STREAM, 0);
+    scopeGuard.appoint();
+    xbind(fd, reinterpret_cast<::sockaddr *>(&name), nameSize);
+    xlisten(fd, backlog);
+    UnixSocket instance(fd);
+    scopeGuard.dismiss();
+    return instance;
+}
+
+
+UnixSocket
+UnixSocket::Connect(const char *path, int timeout)
+{
+    ::sockaddr_un name;
+    ::socklen_t nameSize = MakeName(path, &name);
+    int fd;
+    ScopeGuard scopeGuard([&fd] { ::Close(fd); });
+    fd = XSocket(AF_UNIX, SOCK_STREAM, 0);
+    scopeGuard.appoint();
+    XConnect(fd, reinterpret_cast<::sockaddr *>(&name), nameSize, timeout);
+    UnixSocket instance(fd);
+    scopeGuard.dismiss();
+    return instance;
+}
+
+
+UnixSocket::UnixSocket(int fd)
+    : socket_(fd)
+{
+}
+
+
+UnixSocket
+UnixSocket::accept(int timeout) const
+{
+    return UnixSocket(XAccept4(socket_.getFD(), nullptr, nullptr, 0, timeout));
+}
+
+
+std::size_t
+UnixSocket::accept(std::vector<UnixSocket> *instances, std::size_t maxNumberOfInstances
+                   , int timeout) const
+{
+    assert(instances != nullptr);
+
+    return socket_.accept(nullptr, 0, maxNumberOfInstances, timeout, [instances] (int subFD) {
+        instances->push_back(UnixSocket(subFD));
+        return 0;
+    });
+}
+
+
+int
+UnixSocket::tryAccept(std::vector<UnixSocket> *instances, int timeout) const
+{
+    assert(instances != nullptr);
+    int subFD = IORing::Accept4(socket_.getFD(), nullptr, nullptr, 0, timeout);
+
+    if (subFD < 0) {
+        return errno;
+    }
+
+    instances->push_back(UnixSocket(subFD));
+    return 0;
+}
+
+
+namespace {
+
+::socklen_t
+MakeName(const char *path, ::sockaddr_un *name)
+{
+    std::size_t pathLength = std::strlen(path);
+
+    if (pathLength >= sizeof name->sun_path) {
+        throw GINK_SYSTEM_ERROR(ENAMETOOLONG, "path too long");
+    }
+
+    std::memset(name, 0, sizeof *name);
+    name->sun_family = AF_UNIX;
+    std::memcpy(name->sun_path, path, pathLength);
+
+    if (path[0] == '@') {
+        name->sun_path[0] = '\0';
+        return offsetof(::sockaddr_un, sun_path) + pathLength;
+    }
+
+    return sizeof *name;
+}
+
+} // namespace
+
+} // namespace Gink
@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Archive.h"
+#include "Stream.h"
+#include "SystemError.h"
+
+
+namespace {
+
+enum class Small : std::int8_t
+{
+    A = -1,
+    B = 100,
+};
+
+enum class Large : std::int32_t
+{
+    A = -70000,
+    B = 3,
+};
+
+enum Plain : std::uint16_t
+{
+    PlainA = 1,
+    PlainB = 60000,
+};
+
+struct Record
+{
+    Large large;
+    Small small;
+    Plain plains[2];
+    std::vector<Large> larges;
+
+    GINK_SERIALIZABLE(Record, large, small, plains, larges)
+};
+
+struct Item
+{
+    std::int32_t id;
+    std::string name;
+    std::vector<std::uint16_t> codes;
+
+    GINK_SERIALIZABLE(Item, id, name, codes)
+};
+
+struct Message
+{
+    std::uint64_t sequence;
+    Item head;
+    std::vector<Item> items;
+    std::vector<std::int64_t> values;
+    double ratio;
+
+    GINK_SERIALIZABLE(Message, sequence, head, items, values, ratio)
+};
+
+
+template<class T>
+void TestBulkIntegers();
+
+void TestTryLoad(Gink::IntegerEncoding, std::size_t, bool);
+Message MakeMessage();
+std::string Store(const Message &, Gink::IntegerEncoding);
+template<class T>
+void TestCompactInteger(T, std::size_t);
+
+template<class T, class U>
+void TestCompactOverflow(U);
+
+void TestCompactIntegers();
+void TestSkipEnums(Gink::IntegerEncoding);
+void TestSkipRestoresCursor(Gink::IntegerEncoding);
+void Check(bool, const char *);
+
+} // namespace
+
+
+int
+main()
+{
+    TestBulkIntegers<std::uint16_t>();
+    TestBulkIntegers<std::int32_t>();
+    TestBulkIntegers<std::uint64_t>();
+
+    const Gink::IntegerEncoding fixed = Gink::IntegerEncoding::Fixed;
+    const Gink::IntegerEncoding compact = Gink::IntegerEncoding::Compact;
+
+    for (std::size_t chunkSize: {1, 3, 64}) {
+        TestTryLoad(fixed, chunkSize, false);
+        TestTryLoad(fixed, chunkSize, true);
+        TestTryLoad(compact, chunkSize, false);
+        TestTryLoad(compact, chunkSize, true);
+    }
+
+    TestCompactIntegers();
+    TestSkipEnums(fixed);
+    TestSkipEnums(compact);
+    TestSkipRestoresCursor(fixed);
+    TestSkipRestoresCursor(compact);
+    std::puts("Archive: OK");
+    return 0;
+}
+
+
+namespace {
+
+template<class T>
+void
+TestBulkIntegers()
+{
+    // Every length up to 80 bytes past the 32-byte and 16-byte shuffle blocks, so the AVX2,
+    // SSSE3 and scalar paths all run on whichever of them the CPU supports.
+    for (std::size_t length = 0; length * sizeof(T) <= 80 + 2 * sizeof(T); ++length) {
+        std::vector<T> integers(length);
+        std::vector<unsigned char> bytes;
+
+        for (std::size_t i = 0; i < length; ++i) {
+            integers[i] = static_cast<T>(0x0102030405060708 * (i + 1));
+
+            for (std::size_t j = sizeof(T); j-- > 0;) {
+                bytes.push_back(static_cast<std::uint64_t>(integers[i]) >> (8 * j));
+            }
+        }
+
+        Gink::Stream stream;
+        Gink::Archive archive(&stream);
+        archive << integers;
+        archive.flush();
+        std::size_t size = stream.getDataSize();
+        Check(size >= bytes.size(), "bulk integers are too short");
+        Check(bytes.empty() || std::memcmp(static_cast<const char *>(stream.getData()) + size
+                                           - bytes.size(), bytes.data(), bytes.size()) == 0
+              , "bulk integers are not big-endian");
+        std::vector<T> result;
+        archive >> result;
+        Check(result == integers, "bulk integers did not round-trip");
+    }
+}
+
+
+void
+TestTryLoad(Gink::IntegerEncoding integerEncoding, std::size_t chunkSize, bool flushes)
+{
+    std::string data = Store(MakeMessage(), integerEncoding);
+    Gink::Stream stream;
+    Gink::Archive archive(&stream, integerEncoding);
+    Message message;
+    std::size_t size = 0;
+
+    for (;;) {
+        std::size_t n = std::min(chunkSize, data.size() - size);
+        stream.write(data.data() + size, n);
+        size += n;
+        std::size_t missingByteCount;
+
+        if (archive.tryLoad(message, &missingByteCount)) {
+            break;
+        }
+
+        Check(size < data.size(), "`tryLoad()` failed with all data available");
+        Check(missingByteCount >= 1 && missingByteCount <= data.size() - size
+              , "`tryLoad()` reported a wrong number of missing bytes");
+
+        if (flushes) {
+            archive.flush();
+        }
+    }
+
+    Check(size == data.size(), "`tryLoad()` succeeded before all data arrived");
+    archive.flush();
+    Check(stream.getDataSize() == 0, "`tryLoad()` did not consume the message exactly");
+    Check(Store(message, integerEncoding) == data, "`tryLoad()` did not restore the message");
+}
+
+
+Message
+MakeMessage()
+{
+    Message message;
+    message.sequence = 0x0123456789ABCDEF;
+    message.head = {-7, "head", {1, 2, 3}};
+
+    for (int i = 0; i < 5; ++i) {
+        Item item = {i * 1000, std::string(i * 7, 'a' + i), {}};
+
+        for (int j = 0; j < i * 40; ++j) {
+            item.codes.push_back(j * 1601);
+        }
+
+        message.items.push_back(item);
+    }
+
+    for (int i = 0; i < 50; ++i) {
+        message.values.push_back((i % 2 == 0 ? 1 : -1) * (std::int64_t(1) << i));
+    }
+
+    message.ratio = 0.625;
+    return message;
+}
+
+
+std::string
+Store(const Message &message, Gink::IntegerEncoding integerEncoding)
+{
+    Gink::Stream stream;
+    Gink::Archive archive(&stream, integerEncoding);
+    archive << message;
+    archive.flush();
+    return std::string(static_cast<const char *>(stream.getData()), stream.getDataSize());
+}
+
+
+void
+TestCompactIntegers()
+{
+    TestCompactInteger<std::uint64_t>(0, 1);
+    TestCompactInteger<std::int64_t>(0, 1);
+    TestCompactInteger<std::int64_t>(1, 1);
+    TestCompactInteger<std::int64_t>(-1, 1);
+
+    for (std::size_t n = 1; n <= 8; ++n) {
+        std::uint64_t limit = std::uint64_t(1) << 7 * n;
+        TestCompactInteger<std::uint64_t>(limit - 1, n);
+        TestCompactInteger<std::uint64_t>(limit, n == 8 ? 9 : n + 1);
+        auto signedLimit = static_cast<std::int64_t>(limit / 2);
+        TestCompactInteger<std::int64_t>(signedLimit - 1, n);
+        TestCompactInteger<std::int64_t>(-signedLimit, n);
+        TestCompactInteger<std::int64_t>(signedLimit, n == 8 ? 9 : n + 1);
+        TestCompactInteger<std::int64_t>(-signedLimit - 1, n == 8 ? 9 : n + 1);
+    }
+
+    TestCompactInteger<std::uint64_t>(UINT64_MAX, 9);
+    TestCompactInteger<std::int64_t>(INT64_MAX, 9);
+    TestCompactInteger<std::int64_t>(INT64_MIN, 9);
+    TestCompactInteger<std::uint16_t>(UINT16_MAX, 3);
+    TestCompactInteger<std::int16_t>(INT16_MIN, 3);
+    TestCompactInteger<std::int32_t>(INT32_MIN, 5);
+    TestCompactOverflow<std::uint16_t>(std::uint64_t(UINT16_MAX) + 1);
+    TestCompactOverflow<std::uint32_t>(UINT64_MAX);
+    TestCompactOverflow<std::int16_t>(std::int64_t(INT16_MIN) - 1);
+    TestCompactOverflow<std::int32_t>(std::int64_t(INT32_MAX) + 1);
+    TestCompactOverflow<std::int32_t>(INT64_MIN);
+}
+
+
+template<class T>
+void
+TestCompactInteger(T integer, std::size_t size)
+{
+    Gink::Stream stream;
+    Gink::Archive archive(&stream, Gink::IntegerEncoding::Compact);
+    std::uint8_t sentinel = 0xA5;
+    archive << integer << sentinel;
+    archive.flush();
+    Check(stream.getDataSize() == size + 1, "a compact integer has the wrong size");
+    Check(Gink::SizeArchive::Measure(integer, Gink::IntegerEncoding::Compact) == size
+          , "`SizeArchive` measured a compact integer wrongly");
+    T result;
+    std::uint8_t sentinelResult;
+    archive >> result >> sentinelResult;
+    Check(result == integer && sentinelResult == sentinel, "a compact integer did not round-trip");
+}
+
+
+template<class T, class U>
+void
+TestCompactOverflow(U integer)
+{
+    Gink::Stream stream;
+    Gink::Archive archive(&stream, Gink::IntegerEncoding::Compact);
+    archive << integer;
+    archive.flush();
+    T result = 0;
+
+    try {
+        archive >> result;
+        Check(false, "an out-of-range compact integer was truncated");
+    } catch (const Gink::SystemError &systemError) {
+        Check(systemError.getErrorNumber() == EBADMSG
+              , "an out-of-range compact integer failed unexpectedly");
+    }
+
+    Check(result == 0, "an out-of-range compact integer was stored");
+}
+
+
+void
+TestSkipEnums(Gink::IntegerEncoding integerEncoding)
+{
+    Gink::Stream stream;
+    Gink::Archive archive(&stream, integerEncoding);
+    Record record = {Large::A, Small::B, {PlainA, PlainB}, {Large::B, Large::A, Large::B}};
+    std::uint32_t sentinel = 0xDEADBEEF;
+    archive << record << Large::A << sentinel;
+    archive.flush();
+    std::size_t size = Gink::SizeArchive::Measure(record, integerEncoding);
+    Check(archive.skip<Record>().size == size, "`skip<Record>()` consumed the wrong size");
+    archive.skip<Large>();
+    std::uint32_t value;
+    archive >> value;
+    Check(value == sentinel, "skipping enums desynchronized the archive");
+}
+
+
+void
+TestSkipRestoresCursor(Gink::IntegerEncoding integerEncoding)
+{
+    Gink::Stream input;
+    Gink::Archive writer(&input, integerEncoding);
+    Record record = {Large::B, Small::A, {PlainB, PlainA}, std::vector<Large>(100, Large::A)};
+    writer << record;
+    writer.flush();
+    Gink::Stream stream;
+    Gink::Archive archive(&stream, integerEncoding);
+    std::size_t size = input.getDataSize();
+    stream.write(input.getData(), size / 2);
+
+    try {
+        archive.skip<Record>();
+        Check(false, "`skip<Record>()` succeeded on truncated data");
+    } catch (const Gink::SystemError &systemError) {
+        Check(systemError.getErrorNumber() == ENODATA, "`skip<Record>()` failed unexpectedly");
+    }
+
+    stream.write(static_cast<const char *>(input.getData()) + size / 2, size - size / 2);
+    Check(archive.skip<Record>().size == size, "`skip<Record>()` did not restore the cursor");
+}
+
+
+void
+Check(bool condition, const char *message)
+{
+    if (!condition) {
+        std::fprintf(stderr, "Archive: %s\n", message);
+        std::exit(1);
+    }
+}
+
+} // namespace
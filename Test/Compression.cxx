@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "Compression.h"
+#include "Stream.h"
+#include "SystemError.h"
+
+
+namespace {
+
+void TestRoundTrip(const std::string &, const char *);
+void TestIncompressible();
+void TestWindowEdge();
+void TestCorruptBlocks();
+void TestTruncatedInput();
+std::string Compress(const std::string &);
+std::string Decompress(const std::string &, std::size_t);
+void ExpectBadMessage(const std::string &, const char *);
+std::string MakeText(std::size_t);
+std::string MakeNoise(std::size_t, std::uint32_t);
+void Put32(std::string *, std::size_t, std::uint32_t);
+void Check(bool, const char *);
+
+} // namespace
+
+
+int
+main()
+{
+    TestRoundTrip("", "empty input");
+    TestRoundTrip("a", "one byte");
+    TestRoundTrip(std::string(100000, 'x'), "a run over one block");
+    TestRoundTrip(MakeText(300000), "text over several blocks");
+    TestIncompressible();
+    TestWindowEdge();
+    TestCorruptBlocks();
+    TestTruncatedInput();
+    std::puts("Compression: OK");
+    return 0;
+}
+
+
+namespace {
+
+void
+TestRoundTrip(const std::string &data, const char *message)
+{
+    std::string compressedData = Compress(data);
+
+    for (std::size_t chunkSize: {std::size_t(1) << 30, std::size_t(1000), std::size_t(7)}) {
+        Check(Decompress(compressedData, chunkSize) == data, message);
+    }
+}
+
+
+void
+TestIncompressible()
+{
+    std::string data = MakeNoise(200000, 1);
+    std::string compressedData = Compress(data);
+    // Raw blocks cost only their 9-byte headers and the end block.
+    Check(compressedData.size() == data.size() + 4 * 9 + 1, "noise was not stored raw");
+    Check(Decompress(compressedData, 4096) == data, "noise did not round-trip");
+}
+
+
+void
+TestWindowEdge()
+{
+    // The farthest back a 4-byte match can reach inside a 64 KiB block is 65532 bytes.
+    std::string data = MakeNoise(65536, 2);
+    data.replace(65532, 4, data, 0, 4);
+    TestRoundTrip(data, "a match at the window edge did not round-trip");
+    TestRoundTrip(data + data, "repeated 64 KiB blocks did not round-trip");
+
+    // A hand-made block: 65532 literals, then a match of 4 bytes at offset 65532.
+    std::string literals = MakeNoise(65532, 3);
+    std::string block(1, '\xF0');
+    block.append((65532 - 15) / 255, '\xFF');
+    block.push_back(static_cast<char>((65532 - 15) % 255));
+    block += literals;
+    block.push_back(static_cast<char>(65532 & 255));
+    block.push_back(static_cast<char>(65532 >> 8));
+    block.push_back('\0');
+    std::string compressedData(9, '\x02');
+    Put32(&compressedData, 1, block.size());
+    Put32(&compressedData, 5, 65536);
+    compressedData += block;
+    compressedData.push_back('\0');
+    Check(Decompress(compressedData, 1 << 30) == literals + literals.substr(0, 4)
+          , "a hand-made match at offset 65532 was decoded wrongly");
+
+    // The same match one byte farther back than the decoded output reaches.
+    block[block.size() - 3] = static_cast<char>(65533 & 255);
+    compressedData.replace(9, block.size(), block);
+    ExpectBadMessage(compressedData, "a match before the block start was accepted");
+}
+
+
+void
+TestCorruptBlocks()
+{
+    std::string data = MakeText(100000);
+    std::string compressedData = Compress(data);
+    Check(compressedData[0] == '\x02', "text was not compressed");
+
+    std::string corruptData = compressedData;
+    corruptData[0] = '\x07';
+    ExpectBadMessage(corruptData, "an unknown block kind was accepted");
+
+    corruptData = compressedData;
+    Put32(&corruptData, 5, 65537);
+    ExpectBadMessage(corruptData, "an oversized block was accepted");
+
+    corruptData = compressedData;
+    corruptData[0] = '\x01';
+    ExpectBadMessage(corruptData, "a raw block with a wrong stored size was accepted");
+
+    corruptData = compressedData;
+    Put32(&corruptData, 5, 65535);
+    ExpectBadMessage(corruptData, "a block longer than its header was accepted");
+
+    // Dropping the last byte of a stored block leaves its final literals short.
+    std::uint32_t storedSize = static_cast<unsigned char>(compressedData[1]) << 24
+                               | static_cast<unsigned char>(compressedData[2]) << 16
+                               | static_cast<unsigned char>(compressedData[3]) << 8
+                               | static_cast<unsigned char>(compressedData[4]);
+    corruptData = compressedData;
+    corruptData.erase(9 + storedSize - 1, 1);
+    Put32(&corruptData, 1, storedSize - 1);
+    ExpectBadMessage(corruptData, "a truncated stored block was accepted");
+
+    for (std::size_t i = 9; i < 9 + storedSize; i += 97) {
+        corruptData = compressedData;
+        corruptData[i] = ~corruptData[i];
+
+        try {
+            Decompress(corruptData, 1 << 30);
+        } catch (const Gink::SystemError &systemError) {
+            Check(systemError.getErrorNumber() == EBADMSG, "corrupt data failed unexpectedly");
+        }
+    }
+}
+
+
+void
+TestTruncatedInput()
+{
+    std::string data = MakeText(150000);
+    std::string compressedData = Compress(data);
+    Gink::Stream input;
+    Gink::Stream output;
+    Gink::Decompressor decompressor;
+    std::size_t size = compressedData.size() - 100;
+    input.write(compressedData.data(), size);
+    Check(!decompressor.decompress(&input, &output), "a truncated message was completed");
+    Check(output.getDataSize() < data.size(), "a truncated block was decoded");
+    input.write(compressedData.data() + size, compressedData.size() - size);
+    Check(decompressor.decompress(&input, &output), "a completed message was not finished");
+    Check(input.getDataSize() == 0, "the message was not consumed exactly");
+    Check(std::string(static_cast<const char *>(output.getData()), output.getDataSize()) == data
+          , "a message fed in two parts did not round-trip");
+}
+
+
+std::string
+Compress(const std::string &data)
+{
+    Gink::Stream input;
+    Gink::Stream output;
+    input.write(data.data(), data.size());
+    Gink::Compressor compressor;
+    compressor.compress(&input, &output);
+    Check(input.getDataSize() == 0, "the input was not consumed");
+    return std::string(static_cast<const char *>(output.getData()), output.getDataSize());
+}
+
+
+std::string
+Decompress(const std::string &compressedData, std::size_t chunkSize)
+{
+    Gink::Stream input;
+    Gink::Stream output;
+    Gink::Decompressor decompressor;
+    std::size_t i = 0;
+
+    for (;;) {
+        std::size_t n = std::min(chunkSize, compressedData.size() - i);
+        input.write(compressedData.data() + i, n);
+        i += n;
+
+        if (decompressor.decompress(&input, &output)) {
+            break;
+        }
+
+        Check(i < compressedData.size(), "a complete message was not finished");
+    }
+
+    Check(i == compressedData.size() && input.getDataSize() == 0
+          , "the message was not consumed exactly");
+    return std::string(static_cast<const char *>(output.getData()), output.getDataSize());
+}
+
+
+void
+ExpectBadMessage(const std::string &compressedData, const char *message)
+{
+    try {
+        Decompress(compressedData, 1 << 30);
+        Check(false, message);
+    } catch (const Gink::SystemError &systemError) {
+        Check(systemError.getErrorNumber() == EBADMSG, message);
+    }
+}
+
+
+std::string
+MakeText(std::size_t size)
+{
+    static const char *const words[] = {
+        "stream ", "archive ", "socket ", "buffer ", "segment ", "budget ", "compact ", "ring ",
+    };
+
+    std::string text;
+    std::uint32_t state = 12345;
+
+    while (text.size() < size) {
+        state = state * 1103515245 + 12345;
+        text += words[state >> 16 & 7];
+    }
+
+    text.resize(size);
+    return text;
+}
+
+
+std::string
+MakeNoise(std::size_t size, std::uint32_t seed)
+{
+    std::string noise(size, '\0');
+    std::uint64_t state = seed * UINT64_C(0x9E3779B97F4A7C15);
+
+    for (char &byte: noise) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        byte = static_cast<char>(state >> 24);
+    }
+
+    return noise;
+}
+
+
+void
+Put32(std::string *data, std::size_t offset, std::uint32_t integer)
+{
+    (*data)[offset] = static_cast<char>(integer >> 24);
+    (*data)[offset + 1] = static_cast<char>(integer >> 16);
+    (*data)[offset + 2] = static_cast<char>(integer >> 8);
+    (*data)[offset + 3] = static_cast<char>(integer);
+}
+
+
+void
+Check(bool condition, const char *message)
+{
+    if (!condition) {
+        std::fprintf(stderr, "Compression: %s\n", message);
+        std::exit(1);
+    }
+}
+
+} // namespace
@@ -0,0 +1,104 @@
+#include <netinet/in.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "ConnectionPool.h"
+#include "Coroutine.h"
+#include "SystemError.h"
+#include "TCPSocket.h"
+
+
+namespace {
+
+void TestExhaustedPool();
+int GetLocalPort(const Gink::TCPSocket &);
+void Check(bool, const char *);
+
+} // namespace
+
+
+int
+CoMain(int, char **)
+{
+    TestExhaustedPool();
+    std::puts("ConnectionPool: OK");
+    return 0;
+}
+
+
+namespace {
+
+void
+TestExhaustedPool()
+{
+    // Connections complete in the backlog, so nothing needs to accept them.
+    Gink::TCPSocket listener = Gink::TCPSocket::Listen("127.0.0.1", "0");
+    std::string serviceName = std::to_string(GetLocalPort(listener));
+    Gink::ConnectionPool pool(1);
+    int localPort = -1;
+    bool isAcquired = false;
+
+    {
+        Gink::ConnectionPool::Lease lease = pool.acquire("127.0.0.1", serviceName.c_str());
+
+        try {
+            pool.acquire("127.0.0.1", serviceName.c_str(), 0);
+            Check(false, "an exhausted pool did not fail at once");
+        } catch (const Gink::SystemError &systemError) {
+            Check(systemError.getErrorNumber() == ETIMEDOUT
+                  , "an exhausted pool failed unexpectedly");
+        }
+
+        try {
+            pool.acquire("127.0.0.1", serviceName.c_str(), 50);
+            Check(false, "an exhausted pool did not time out");
+        } catch (const Gink::SystemError &systemError) {
+            Check(systemError.getErrorNumber() == ETIMEDOUT
+                  , "an exhausted pool failed unexpectedly");
+        }
+
+        Gink::CoAdd([&] () -> void {
+            Gink::ConnectionPool::Lease lease = pool.acquire("127.0.0.1", serviceName.c_str()
+                                                             , 5000);
+            localPort = GetLocalPort(lease.getSocket());
+            isAcquired = true;
+        });
+
+        Gink::CoSleep(20);
+        Check(!isAcquired, "a connection was acquired beyond the limit");
+        localPort = GetLocalPort(lease.getSocket());
+    }
+
+    int releasedLocalPort = localPort;
+
+    for (int i = 0; i < 100 && !isAcquired; ++i) {
+        Gink::CoSleep(10);
+    }
+
+    Check(isAcquired, "a released connection did not wake the waiter");
+    Check(localPort == releasedLocalPort, "the waiter did not reuse the released connection");
+}
+
+
+int
+GetLocalPort(const Gink::TCPSocket &socket)
+{
+    ::sockaddr_in name;
+    socket.getLocalEndpoint().get(&name);
+    return ntohs(name.sin_port);
+}
+
+
+void
+Check(bool condition, const char *message)
+{
+    if (!condition) {
+        std::fprintf(stderr, "ConnectionPool: %s\n", message);
+        std::exit(1);
+    }
+}
+
+} // namespace
@@ -0,0 +1,83 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Coroutine.h"
+#include "Stream.h"
+#include "SystemError.h"
+#include "UDPSocket.h"
+
+
+namespace {
+
+void TestEmptyStreams();
+std::size_t Receive(const Gink::UDPSocket &, Gink::Stream *, int);
+void Check(bool, const char *);
+
+} // namespace
+
+
+int
+CoMain(int, char **)
+{
+    TestEmptyStreams();
+    std::puts("UDPSocket: OK");
+    return 0;
+}
+
+
+namespace {
+
+void
+TestEmptyStreams()
+{
+    Gink::UDPSocket receiver = Gink::UDPSocket::Bind("127.0.0.1", "0");
+    Gink::UDPSocket sender = Gink::UDPSocket::Bind("127.0.0.1", "0");
+    Gink::IPEndpoint endpoints[3] = {
+        receiver.getLocalEndpoint(), receiver.getLocalEndpoint(), receiver.getLocalEndpoint(),
+    };
+
+    Gink::Stream emptyStream;
+    Gink::Stream *streams1[1] = {&emptyStream};
+    Check(sender.send(streams1, endpoints, 1) == 0, "an empty stream was counted as sent");
+    Gink::Stream stream;
+    Check(Receive(receiver, &stream, 50) == 0, "an empty stream was sent as a datagram");
+
+    Gink::Stream streams2[3];
+    streams2[1].write("ping", 4);
+    Gink::Stream *streams3[3] = {&streams2[0], &streams2[1], &streams2[2]};
+    Check(sender.send(streams3, endpoints, 3) == 4, "a mixed batch was miscounted");
+    Check(streams2[1].getDataSize() == 0, "a sent stream was not consumed");
+    Check(Receive(receiver, &stream, 1000) == 1, "a non-empty stream was not sent");
+    Check(stream.getDataSize() == 4 && std::memcmp(stream.getData(), "ping", 4) == 0
+          , "a datagram was received wrongly");
+    stream.read(nullptr, stream.getDataSize());
+    Check(Receive(receiver, &stream, 50) == 0, "empty streams in a batch were sent as datagrams");
+}
+
+
+std::size_t
+Receive(const Gink::UDPSocket &socket, Gink::Stream *stream, int timeout)
+{
+    Gink::IPEndpoint endpoint;
+
+    try {
+        return socket.receive(&stream, &endpoint, 1, nullptr, timeout);
+    } catch (const Gink::SystemError &systemError) {
+        Check(systemError.getErrorNumber() == ETIMEDOUT, "receiving failed unexpectedly");
+        return 0;
+    }
+}
+
+
+void
+Check(bool condition, const char *message)
+{
+    if (!condition) {
+        std::fprintf(stderr, "UDPSocket: %s\n", message);
+        std::exit(1);
+    }
+}
+
+} // namespace